@@ -0,0 +1,79 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef AGGREGATOR_H
+#define AGGREGATOR_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "snapshot.h"
+
+/*
+Fleet view over many collectors
+All connections share one epoll loop. The latest snapshot of every node is
+kept and once per second the per-node top lists are merged into a
+fleet-wide top N, which is written to standard output. Lost collectors are
+reconnected on the next second.
+*/
+class Aggregator {
+ public:
+  Aggregator(const std::vector<std::string>& endpoints, std::size_t top);
+  ~Aggregator();
+  Aggregator(const Aggregator&) = delete;
+  Aggregator& operator=(const Aggregator&) = delete;
+  void Run();
+
+ private:
+  struct Node {
+    std::string endpoint;
+    int fd{-1};
+    std::string buffer;
+    bool online{false};
+    Snapshot snapshot;
+  };
+  std::vector<Node> nodes_;
+  std::size_t top_;
+  int epoll_fd_{-1};
+  std::string output_;
+  void Connect(std::size_t index);
+  void Receive(std::size_t index);
+  void Disconnect(std::size_t index);
+  void Print();
+};
+
+#endif
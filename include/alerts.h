@@ -0,0 +1,119 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ALERTS_H
+#define ALERTS_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "process.h"
+#include "streaming_stats.h"
+
+/*
+Alert rules evaluated on streaming statistics
+A rule is a line of the form
+  [system] METRIC > NUMBER
+  [system] METRIC > pQ [+ Ksigma] [over DURATION]
+  [system] METRIC grows N% over DURATION
+Process metrics are cpu (percent of one CPU over the last interval), ram
+(MB) and io (kB/s read and written); system metrics are cpu, memory and
+pressure, all in percent. A quantile rule compares every sample with the
+estimated quantile of the samples before it plus K exponentially weighted
+standard deviations over DURATION (10m by default); a growth rule
+compares it with its exponentially weighted mean over DURATION. Every
+rule keeps one StreamingStats per process, so no history is stored.
+*/
+class Alerts {
+ public:
+  struct Alert {
+    int pid{0};  // 0 for system-wide rules
+    std::string subject;
+    const std::string* rule;
+    double value{0};
+    double limit{0};
+  };
+
+  explicit Alerts(const std::vector<std::string>& rules = {});
+  void Update(const std::vector<Process>& processes, float cpu, float memory,
+              float pressure);
+  bool Firing(int pid) const;
+  const std::vector<Alert>& Firing() const;
+  const std::vector<Alert>& Started() const;
+  const std::vector<Alert>& Resolved() const;
+
+ private:
+  enum Metric { kCpu = 0, kRam, kIo, kMemory, kPressure };
+  enum Kind { kAbove = 0, kQuantile, kGrowth };
+  struct Rule {
+    std::string text;
+    bool system{false};
+    Metric metric{kCpu};
+    Kind kind{kAbove};
+    double threshold{0};
+    double quantile{0.99};
+    double sigmas{0};
+    double window{600};
+    // Index of the rule's statistics within the series of its kind, since
+    // process series only hold process rules and the system series only
+    // system rules
+    std::size_t slot{0};
+  };
+  struct Series {
+    unsigned generation{0};
+    long jiffies{-1};
+    long io{-1};
+    bool firing{false};
+    std::vector<StreamingStats> stats;
+    std::vector<bool> rule_firing;
+  };
+  std::vector<Rule> rules_;
+  std::unordered_map<int, Series> processes_;
+  Series system_;
+  unsigned generation_{0};
+  long last_update_ns_{0};
+  std::vector<Alert> firing_;
+  std::vector<Alert> started_;
+  std::vector<Alert> resolved_;
+  static Rule Parse(const std::string& text);
+  Series NewSeries(bool system) const;
+  void Evaluate(Series& series, const Process* process,
+                const double (&values)[5], double seconds);
+};
+
+#endif
@@ -0,0 +1,79 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/*
+Bump allocator for data that lives for one tick
+Allocations are carved out of large blocks and never freed one by one;
+Reset() makes the whole arena reusable at once while keeping its blocks,
+so once the arena has grown to a tick's working set, later ticks do not
+touch the heap. Only trivially destructible objects belong in an arena.
+*/
+class Arena {
+ public:
+  explicit Arena(std::size_t block_size = 64 * 1024);
+  Arena(Arena&&) = default;
+  Arena& operator=(Arena&&) = default;
+
+  void* Allocate(std::size_t size, std::size_t alignment);
+  std::string_view Copy(std::string_view text);
+  void Reset();
+
+  // Uninitialized storage for count objects of type T
+  template <typename T>
+  T* Allocate(std::size_t count) {
+    return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+  }
+
+ private:
+  struct Block {
+    std::unique_ptr<char[]> data;
+    std::size_t size;
+  };
+  std::size_t block_size_;
+  std::vector<Block> blocks_;
+  std::size_t block_{0};
+  std::size_t used_{0};
+};
+
+#endif
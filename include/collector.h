@@ -0,0 +1,88 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef COLLECTOR_H
+#define COLLECTOR_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "metrics_server.h"
+#include "snapshot.h"
+#include "system.h"
+
+/*
+Headless daemon that publishes System snapshots
+Every process refresh the snapshot is encoded once and pushed to all
+connected aggregators. A client that has not drained the previous frame
+skips the new one instead of buffering without bound. Either endpoint may
+be empty; with a metrics endpoint the same snapshot is also exposed to
+Prometheus scrapers. Alerts that start or resolve are printed to stdout.
+*/
+class Collector {
+ public:
+  Collector(System& system, const std::string& endpoint,
+            const std::string& metrics_endpoint, std::string host,
+            std::size_t top);
+  ~Collector();
+  Collector(const Collector&) = delete;
+  Collector& operator=(const Collector&) = delete;
+  void Run();
+
+ private:
+  struct Client {
+    std::string pending;
+    std::size_t sent{0};
+  };
+  System& system_;
+  std::string host_;
+  std::size_t top_;
+  int listen_fd_{-1};
+  int epoll_fd_{-1};
+  Snapshot snapshot_;
+  std::string frame_;
+  std::unordered_map<int, Client> clients_;
+  std::unique_ptr<MetricsServer> metrics_;
+  void Accept();
+  void Publish();
+  void ReportAlerts();
+  bool Flush(int fd, Client& client);
+  void Drop(int fd);
+};
+
+#endif
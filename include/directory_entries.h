@@ -0,0 +1,79 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef DIRECTORY_ENTRIES_H
+#define DIRECTORY_ENTRIES_H
+
+#include <cstdint>
+#include <vector>
+
+/*
+Directory listing with getdents64 into a caller owned buffer
+The records are visited in place, so listing /proc or /proc/[pid]/fd
+allocates nothing once the buffer exists.
+*/
+namespace DirectoryEntries {
+// Layout of the records returned by getdents64(2)
+struct Dirent64 {
+  std::uint64_t d_ino;
+  std::int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[];
+};
+
+// Fills buffer with the next records of the open directory. Returns the
+// bytes filled, 0 at the end of the directory and -1 on errors.
+long Read(int directory, std::vector<char>& buffer);
+
+// Calls visit(name, type) for every entry, "." and ".." included, until it
+// returns false; type is a DT_* constant of <dirent.h>
+template <typename Visit>
+void ForEach(int directory, std::vector<char>& buffer, Visit visit) {
+  for (;;) {
+    const long size = Read(directory, buffer);
+    if (size <= 0) return;
+    for (long offset = 0; offset < size;) {
+      const Dirent64* entry =
+          reinterpret_cast<const Dirent64*>(buffer.data() + offset);
+      offset += entry->d_reclen;
+      if (!visit(entry->d_name, entry->d_type)) return;
+    }
+  }
+}
+}  // namespace DirectoryEntries
+
+#endif
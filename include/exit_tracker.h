@@ -0,0 +1,94 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef EXIT_TRACKER_H
+#define EXIT_TRACKER_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "process.h"
+
+/*
+Accounting of processes that exited between two process scans
+Exits are counted from the kernel process event connector when it is
+available and from PIDs that disappeared between scans otherwise. Their
+CPU time is recovered from the cutime/cstime growth of the parents that
+reaped them, split evenly over the children that parent lost this tick.
+*/
+class ExitTracker {
+ public:
+  struct Summary {
+    std::string command;
+    int count{0};
+    long jiffies{0};
+  };
+
+  ExitTracker() = default;
+  ~ExitTracker();
+  ExitTracker(const ExitTracker&) = delete;
+  ExitTracker& operator=(const ExitTracker&) = delete;
+
+  void Enable(bool enable);
+  bool Enabled() const;
+  bool Events() const;
+  int EventFd() const;
+  void Poll();
+  void Exited(const Process& process);
+  void Reaped(const Process& parent);
+  void EndTick();
+  const std::vector<Summary>& Exits() const;
+
+ private:
+  struct Child {
+    std::string command;
+    int parent_pid{0};
+  };
+  bool enabled_{false};
+  int event_fd_{-1};
+  // Processes announced by fork and exec events that are still alive
+  std::unordered_map<int, Child> children_;
+  // Processes that exited during the current tick
+  std::unordered_map<int, Child> exited_;
+  // Child CPU reaped by each parent during the current tick
+  std::unordered_map<int, std::pair<std::string, long>> reaped_;
+  std::vector<Summary> exits_;
+  void Subscribe();
+  void Handle(const void* data);
+};
+
+#endif
@@ -0,0 +1,73 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef FD_SCANNER_H
+#define FD_SCANNER_H
+
+#include <vector>
+
+/*
+Counter of the open file descriptors of a process
+/proc/[pid]/fd is listed with getdents64 into a buffer kept between calls,
+and every entry's link target is read to tell sockets, pipes and files
+(anything with a path) apart. The cost grows with the number of
+descriptors, so callers decide which processes to count and give each
+listing a deadline.
+*/
+class FdScanner {
+ public:
+  struct Counts {
+    // -1 until the process was counted
+    int total{-1};
+    int sockets{0};
+    int pipes{0};
+    int files{0};
+    // Soft RLIMIT_NOFILE from /proc/[pid]/limits, -1 when unlimited or
+    // unknown
+    long limit{-1};
+  };
+
+  enum class Result { kCounted, kDenied, kTimedOut };
+
+  FdScanner();
+  Result Count(int pid, long deadline_ns, Counts& counts);
+
+ private:
+  std::vector<char> buffer_;
+};
+
+#endif
@@ -0,0 +1,73 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "process.h"
+
+/*
+Process filter compiled once from a query string
+Terms are separated by spaces and all of them have to match:
+  user:NAME  cmd:TEXT  re:REGEX  cgroup:TEXT  cpu>N  cpu<N  ram>N  ram<N
+A bare word is a command substring, CPU is in percent and RAM in MB.
+Terms are evaluated cheapest first, so lazily read fields such as the
+command line are only loaded for processes that passed everything else.
+*/
+class Filter {
+ public:
+  Filter() = default;
+  explicit Filter(const std::string& query);
+  bool Empty() const;
+  std::string Query() const;
+  bool Matches(const Process& process) const;
+
+ private:
+  enum Cost { kCached = 0, kFile };
+  struct Term {
+    Cost cost;
+    std::function<bool(const Process&)> matches;
+  };
+  std::string query_;
+  std::vector<Term> terms_;
+  void Compile(const std::string& term);
+};
+
+#endif
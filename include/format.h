@@ -42,6 +42,7 @@
 namespace Format {
 std::string ElapsedTime(long times);
 std::string Padding(long number);
+std::string Rate(float per_second);
 }  // namespace Format
 
 #endif
\ No newline at end of file
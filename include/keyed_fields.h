@@ -0,0 +1,160 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef KEYED_FIELDS_H
+#define KEYED_FIELDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/*
+Single pass scanner for "key: value" and "key=value" files
+A schema is a constexpr table mapping keys to members of a record, all of
+them long or all of them std::string, e.g.
+  constexpr KeyedFields::Field<MemInfo> kMemInfo[] = {
+      {"MemTotal", &MemInfo::total}, {"MemFree", &MemInfo::free}};
+Scan() reads the file once, compares a line's key only against schema keys
+of the same length, writes the parsed value straight into the record and
+stops reading as soon as every key was found.
+*/
+namespace KeyedFields {
+// Value is the type of every member a schema fills, long or std::string
+template <typename Record, typename Value = long>
+struct Field {
+  std::string_view key;
+  Value Record::*member;
+};
+
+// Value parsers shared by all schemas
+long ParseLong(const char* begin, const char* end);
+std::string ParseString(const char* begin, const char* end);
+
+// Thin wrappers so the template does not pull POSIX headers into every
+// includer. Read returns the bytes read, 0 at end of file or on errors.
+int Open(const std::string& path);
+std::size_t Read(int fd, char* buffer, std::size_t size);
+void Close(int fd);
+
+// Parses one line and returns the bit of the schema entry it matched
+template <typename Record, typename Value, std::size_t N>
+uint64_t MatchLine(const char* begin, const char* end, char separator,
+                   const Field<Record, Value> (&fields)[N], Record& record) {
+  const char* split =
+      static_cast<const char*>(std::memchr(begin, separator, end - begin));
+  if (split == nullptr) return 0;
+  const std::size_t length = split - begin;
+  for (std::size_t i = 0; i < N; ++i) {
+    const std::string_view key = fields[i].key;
+    if (key.size() != length || key[0] != begin[0] ||
+        std::memcmp(key.data(), begin, length) != 0) {
+      continue;
+    }
+    // Numeric schemas never instantiate the string path
+    if constexpr (std::is_same_v<Value, std::string>) {
+      record.*fields[i].member = ParseString(split + 1, end);
+    } else {
+      static_assert(std::is_same_v<Value, long>, "values are long or string");
+      record.*fields[i].member = ParseLong(split + 1, end);
+    }
+    return uint64_t{1} << i;
+  }
+  return 0;
+}
+
+// Same as Scan() for text that is already in memory
+template <typename Record, typename Value, std::size_t N>
+uint64_t Parse(std::string_view text, char separator,
+               const Field<Record, Value> (&fields)[N], Record& record) {
+  static_assert(N <= 64, "a schema holds at most 64 keys");
+  const uint64_t all = N == 64 ? ~uint64_t{0} : (uint64_t{1} << N) - 1;
+  uint64_t found{0};
+  const char* begin = text.data();
+  const char* const last = text.data() + text.size();
+  while (found != all && begin < last) {
+    const char* newline =
+        static_cast<const char*>(std::memchr(begin, '\n', last - begin));
+    const char* end = newline != nullptr ? newline : last;
+    found |= MatchLine(begin, end, separator, fields, record);
+    begin = end + 1;
+  }
+  return found;
+}
+
+// Reads a file line by line through a fixed buffer, so callers parse in
+// place without allocating. Lines that do not fit the buffer are skipped.
+class LineReader {
+ public:
+  explicit LineReader(const std::string& path);
+  ~LineReader();
+  LineReader(const LineReader&) = delete;
+  LineReader& operator=(const LineReader&) = delete;
+
+  bool IsOpen() const { return fd_ >= 0; }
+  // Next line without its newline; false at the end of the file. The view
+  // is valid until the next call.
+  bool Next(std::string_view& line);
+
+ private:
+  int fd_;
+  char buffer_[4096];
+  std::size_t size_{0};
+  std::size_t line_{0};
+  bool end_of_file_;
+  bool overlong_{false};
+};
+
+// Returns a bitmask of the schema entries that were found
+template <typename Record, typename Value, std::size_t N>
+uint64_t Scan(const std::string& path, char separator,
+              const Field<Record, Value> (&fields)[N], Record& record) {
+  static_assert(N <= 64, "a schema holds at most 64 keys");
+  const uint64_t all = N == 64 ? ~uint64_t{0} : (uint64_t{1} << N) - 1;
+  uint64_t found{0};
+  LineReader reader(path);
+  std::string_view line;
+  while (found != all && reader.Next(line)) {
+    found |= MatchLine(line.data(), line.data() + line.size(), separator,
+                       fields, record);
+  }
+  return found;
+}
+}  // namespace KeyedFields
+
+#endif
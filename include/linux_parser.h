@@ -40,11 +40,15 @@
 #include <fstream>
 #include <regex>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace LinuxParser {
 // Paths
-const std::string kProcDirectory{"/proc/"};
+const std::string& ProcDirectory();
+void SetProcDirectory(const std::string& directory);
 const std::string kCmdlineFilename{"/cmdline"};
+const std::string kCgroupFilename{"/cgroup"};
 const std::string kCpuinfoFilename{"/cpuinfo"};
 const std::string kStatusFilename{"/status"};
 const std::string kStatFilename{"/stat"};
@@ -53,9 +57,77 @@ const std::string kMeminfoFilename{"/meminfo"};
 const std::string kVersionFilename{"/version"};
 const std::string kOSPath{"/etc/os-release"};
 const std::string kPasswordPath{"/etc/passwd"};
+const std::string kPressureCpuFilename{"/pressure/cpu"};
+const std::string kVmstatFilename{"/vmstat"};
+const std::string kNumaMapsFilename{"/numa_maps"};
+const std::string kSchedstatFilename{"/schedstat"};
+const std::string kFileNrFilename{"/sys/fs/file-nr"};
+const std::string kPidMaxFilename{"/sys/kernel/pid_max"};
+
+// Records filled by the keyed field scanner, in kB where applicable
+struct MemInfo {
+  long total{0};
+  long free{0};
+};
+
+struct ProcessStatus {
+  long uid{-1};
+  long vm_size{0};
+  long voluntary_switches{0};
+  long involuntary_switches{0};
+};
+
+struct ProcessIo {
+  long read_bytes{0};
+  long write_bytes{0};
+};
+
+// Fields of /proc/[pid]/stat used on every scan; comm points into the
+// parsed line
+struct ProcessStat {
+  std::string_view comm;
+  long parent_pid{0};
+  long minor_faults{0};
+  long major_faults{0};
+  long utime{0};
+  long stime{0};
+  long cutime{0};
+  long cstime{0};
+  long start_time{0};
+  int processor{-1};
+};
+
+// File handles allocated by the whole system and its limit, fs.file-max
+struct FileHandles {
+  long allocated{0};
+  long max{0};
+};
+
+// Nanoseconds a task spent on a CPU and waiting on a run queue, -1 when
+// the kernel was built without schedstats or the process exited
+struct SchedStat {
+  long run_ns{-1};
+  long wait_ns{-1};
+};
+
+// Busy and idle time of one CPU since boot, in USER_HZ
+struct CpuJiffies {
+  long active{0};
+  long idle{0};
+};
+
+struct OsRelease {
+  std::string pretty_name;
+};
 
 // System
 float MemoryUtilization();
+MemInfo ParseMemInfo();
+float CpuPressure();
+long ContextSwitches();
+long MajorFaults();
+long RunQueueDelay();
+FileHandles OpenFiles();
 long UpTime();
 std::vector<int> Pids();
 int TotalProcesses();
@@ -80,15 +152,45 @@ std::vector<std::string> CpuUtilization();
 long Jiffies();
 long ActiveJiffies();
 long ActiveJiffies(int pid);
+long ActiveJiffies(const std::vector<std::string>& cpu_utilization);
 long IdleJiffies();
+long IdleJiffies(const std::vector<std::string>& cpu_utilization);
+CpuJiffies SystemJiffies();
+void PerCpuJiffies(std::vector<CpuJiffies>& cpus);
 
 // Processes
+// Zero based fields of /proc/[pid]/stat
+enum ProcessStatFields {
+  kPid_ = 0,
+  kComm_,
+  kPPid_ = 3,
+  kMinFlt_ = 9,
+  kMajFlt_ = 11,
+  kUTime_ = 13,
+  kSTime_,
+  kCUTime_,
+  kCSTime_,
+  kStartTime_ = 21,
+  kProcessor_ = 38
+};
 std::string Command(int pid);
 std::string Ram(int pid);
 std::string Uid(int pid);
+std::string Uid(const std::string& user);
 std::string User(int pid);
+std::string UserName(const std::string& uid);
+std::string Cgroup(int pid);
 long int UpTime(int pid);
 std::vector<std::string> ParseProcessStat(int pid);
+std::vector<std::string> ParseProcessStat(std::string_view line);
+bool ParseProcessStat(std::string_view line, ProcessStat& stat);
+long ParseStatmSize(std::string_view statm);
+long ParseStatmResident(std::string_view statm);
+ProcessIo ParseProcessIo(std::string_view io);
+ProcessStatus ParseProcessStatus(int pid);
+ProcessStatus ParseProcessStatus(std::string_view status);
+void NumaPages(int pid, std::vector<long>& pages);
+SchedStat ProcessSchedStat(int pid);
 long GetValueFromVectorWithDefaultZero(const std::vector<std::string>& vec,
                                        int index);
 }
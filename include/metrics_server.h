@@ -0,0 +1,88 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+#include "snapshot.h"
+
+/*
+Minimal HTTP endpoint serving /metrics in OpenMetrics text format
+The exposition is rendered once per snapshot into a reusable buffer and
+every scrape is answered from it, so scraping never walks /proc and costs
+the same regardless of the number of processes. Per-process series are
+limited to the top processes of the snapshot, which bounds the label
+cardinality. Connections are served one request each on a private epoll
+instance; EventFd() becomes readable when any of them needs attention.
+Poll() closes connections that stayed idle for a few seconds, so clients
+that connect and never send a request cannot pile up descriptors.
+*/
+class MetricsServer {
+ public:
+  explicit MetricsServer(const std::string& endpoint);
+  ~MetricsServer();
+  MetricsServer(const MetricsServer&) = delete;
+  MetricsServer& operator=(const MetricsServer&) = delete;
+
+  int EventFd() const;
+  void Update(const Snapshot& snapshot);
+  void Poll();
+
+ private:
+  struct Connection {
+    std::string request;
+    std::string response;
+    std::size_t sent{0};
+    // Monotonic time of the last event on the socket, in ns
+    long active{0};
+  };
+  int listen_fd_{-1};
+  int epoll_fd_{-1};
+  std::string body_;
+  std::unordered_map<int, Connection> connections_;
+  void Accept();
+  bool Receive(int fd, Connection& connection);
+  void Respond(Connection& connection);
+  bool Flush(int fd, Connection& connection);
+  void Drop(int fd);
+  void DropIdle(long now);
+};
+
+#endif
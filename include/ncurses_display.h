@@ -39,13 +39,76 @@
 
 #include <curses.h>
 
+#include <string>
+#include <vector>
+
+#include "alerts.h"
+#include "exit_tracker.h"
+#include "filter.h"
+#include "network_traffic.h"
+#include "numa.h"
 #include "process.h"
 #include "system.h"
 
 namespace NCursesDisplay {
-void Display(System& system, int n = 10);
+// Incremental search state, edited with '/', Enter and Escape
+struct Search {
+  bool editing{false};
+  bool valid{true};
+  std::string query;
+  Filter filter;
+};
+
+// Scroll position and sort column of the process table
+struct View {
+  enum Sort {
+    kPid = 0,
+    kUser,
+    kCpu,
+    kRam,
+    kTime,
+    kMinorFaults,
+    kMajorFaults,
+    kVoluntarySwitches,
+    kInvoluntarySwitches,
+    kFdLimit,
+    kCommand
+  };
+  Sort sort{kCpu};
+  bool ascending{false};
+  int offset{0};
+};
+
+// Panels from top to bottom; the optional ones are null while hidden
+struct Windows {
+  WINDOW* system{nullptr};
+  WINDOW* network{nullptr};
+  WINDOW* process{nullptr};
+  WINDOW* numa{nullptr};
+  WINDOW* exit{nullptr};
+};
+
+void Display(System& system);
+void Layout(Windows& windows, bool show_numa, bool show_exits);
 void DisplaySystem(System& system, WINDOW* window);
-void DisplayProcesses(std::vector<Process>& processes, WINDOW* window, int n);
+void DisplayProcesses(const std::vector<const Process*>& processes,
+                      const View& view, const Alerts& alerts, WINDOW* window,
+                      int n);
+void DisplayNetwork(const NetworkTraffic& network,
+                    std::vector<const NetworkTraffic::Interface*>& active,
+                    WINDOW* window);
+void DisplayNuma(const NumaTopology& numa,
+                 const std::vector<Process>& processes,
+                 std::vector<long>& pages, WINDOW* window);
+void DisplayExits(const ExitTracker& exits, WINDOW* window);
+void DisplayStatus(const Search& search, int offset, int rows, int total,
+                   WINDOW* window);
+void FilterProcesses(const std::vector<Process>& processes,
+                     const Filter& filter,
+                     std::vector<const Process*>& matches);
+void SortProcesses(std::vector<const Process*>& processes, const View& view);
+bool HandleSearchKey(int key, Search& search);
+bool HandleViewKey(int key, View& view, int rows, int total);
 std::string ProgressBar(float percent);
 }  // namespace NCursesDisplay
 
@@ -0,0 +1,115 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NETWORK_TRAFFIC_H
+#define NETWORK_TRAFFIC_H
+
+#include <net/if.h>
+
+#include <string>
+#include <vector>
+
+/*
+Per-interface throughput and TCP health from /proc/net
+/proc/net/dev, /proc/net/snmp and /proc/net/sockstat are read into one
+reusable buffer and parsed in place. Interfaces get a stable id the first
+time they are seen and their counters live in a flat array indexed by it,
+so a steady state update allocates nothing. The slots of interfaces that
+vanish from /proc/net/dev are freed and handed to the next new interface.
+*/
+class NetworkTraffic {
+ public:
+  struct Interface {
+    char name[IFNAMSIZ]{};
+    bool present{false};
+    bool up{false};
+    // Cumulative counters from /proc/net/dev
+    long rx_bytes{0};
+    long rx_packets{0};
+    long rx_errors{0};
+    long rx_drops{0};
+    long tx_bytes{0};
+    long tx_packets{0};
+    long tx_errors{0};
+    long tx_drops{0};
+    // Per second rates over the last interval
+    float rx_bytes_rate{0};
+    float rx_packets_rate{0};
+    float tx_bytes_rate{0};
+    float tx_packets_rate{0};
+    float errors_rate{0};
+    float drops_rate{0};
+  };
+
+  NetworkTraffic();
+  ~NetworkTraffic();
+  NetworkTraffic(const NetworkTraffic&) = delete;
+  NetworkTraffic& operator=(const NetworkTraffic&) = delete;
+
+  void Update();
+  const std::vector<Interface>& Interfaces() const;
+  void Active(std::vector<const Interface*>& active) const;
+  float RetransmitRate() const;
+  long SocketsUsed() const;
+  long TcpInUse() const;
+  long TcpTimeWait() const;
+  long UdpInUse() const;
+
+ private:
+  std::vector<Interface> interfaces_;
+  std::vector<int> free_ids_;
+  std::vector<char> buffer_;
+  std::size_t loaded_{0};
+  int socket_fd_{-1};
+  long last_update_ns_{0};
+  long retransmits_{-1};
+  float retransmit_rate_{0};
+  long sockets_used_{0};
+  long tcp_in_use_{0};
+  long tcp_time_wait_{0};
+  long udp_in_use_{0};
+  std::string dev_path_;
+  std::string snmp_path_;
+  std::string sockstat_path_;
+  bool Load(const std::string& path);
+  int Id(const char* name, std::size_t length, std::size_t hint);
+  void UpdateDevices(float seconds);
+  void UpdateSnmp(float seconds);
+  void UpdateSockstat();
+  bool Up(const Interface& interface) const;
+};
+
+#endif
@@ -0,0 +1,72 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <string>
+#include <vector>
+
+#include "linux_parser.h"
+
+/*
+NUMA node topology and per-node CPU utilization
+The CPUs of every node are read from /sys/devices/system/node once; hosts
+without that directory are treated as a single node holding every CPU.
+Update() samples the per-CPU lines of /proc/stat and folds their deltas
+into one utilization per node.
+*/
+class NumaTopology {
+ public:
+  NumaTopology();
+  void Update();
+  int Nodes() const;
+  int NodeOf(int cpu) const;
+  float Utilization(int node) const;
+
+ private:
+  // Node of every CPU number, -1 for CPUs not listed under any node
+  std::vector<int> cpu_nodes_;
+  int nodes_{1};
+  std::vector<LinuxParser::CpuJiffies> previous_;
+  std::vector<LinuxParser::CpuJiffies> current_;
+  std::vector<float> utilization_;
+  // Per node sums of the last interval, kept to reuse their storage
+  std::vector<long> active_;
+  std::vector<long> total_;
+};
+
+#endif
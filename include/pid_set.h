@@ -0,0 +1,72 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef PID_SET_H
+#define PID_SET_H
+
+#include <cstdint>
+#include <vector>
+
+/*
+The PIDs under /proc, as a bitmap and as a sorted list
+The directory is listed with getdents64 into a buffer kept between scans
+and names are parsed in place. The bitmap covers kernel.pid_max, so the
+PIDs that started or exited since the previous scan are the bits that
+differ between two bitmaps, found a 64 bit word at a time.
+*/
+class PidSet {
+ public:
+  PidSet();
+  void Scan();
+  const std::vector<int>& Pids() const;
+  bool Contains(int pid) const;
+  bool Contained(int pid) const;
+  int Started() const;
+  int Exited() const;
+
+ private:
+  std::vector<std::uint64_t> current_;
+  std::vector<std::uint64_t> previous_;
+  std::vector<int> pids_;
+  std::vector<char> buffer_;
+  int started_{0};
+  int exited_{0};
+  void Insert(int pid);
+  static bool Test(const std::vector<std::uint64_t>& bitmap, int pid);
+};
+
+#endif
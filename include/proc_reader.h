@@ -0,0 +1,98 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PROC_READER_H
+#define PROC_READER_H
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// Contents of the per-process files read on every process scan; empty when
+// the file could not be read
+struct ProcFiles {
+  std::string_view stat;
+  std::string_view statm;
+  std::string_view io;
+  std::string_view status;
+};
+
+/*
+Batched reader for /proc/[pid]/{stat,statm,io,status}
+With io_uring the open, read and close calls of a whole batch of PIDs are
+submitted together, so a batch costs three io_uring_enter calls instead of
+three system calls per file. Kernels without io_uring openat/read/close
+support fall back to plain blocking reads into the same buffers, and so
+does a ring that fails mid-batch. The cost of the last scan is kept per
+backend for comparison.
+*/
+class ProcReader {
+ public:
+  enum Backend { kAuto = 0, kSync, kUring };
+  struct Stats {
+    const char* backend{""};
+    long syscalls{0};
+    long nanoseconds{0};
+  };
+
+  explicit ProcReader(Backend backend = kAuto);
+  ~ProcReader();
+  ProcReader(const ProcReader&) = delete;
+  ProcReader& operator=(const ProcReader&) = delete;
+
+  void Read(const std::vector<int>& pids,
+            const std::function<void(int, const ProcFiles&)>& visit);
+  const Stats& LastScan() const;
+  const Stats& LastScan(Backend backend) const;
+
+ private:
+  enum File { kStat = 0, kStatm, kIo, kStatus, kNumFiles };
+  struct Ring;
+  Ring* ring_{nullptr};
+  std::vector<char> buffers_;
+  std::vector<int> lengths_;
+  // Indexed by Backend, kAuto stays empty
+  Stats stats_[3];
+  const Stats* last_{&stats_[kAuto]};
+  long scans_{0};
+  char* Buffer(std::size_t slot);
+  void Path(int pid, File file, char* path) const;
+  void ReadSync(const int* pids, std::size_t count, Stats& stats);
+  bool ReadUring(const int* pids, std::size_t count, Stats& stats);
+};
+
+#endif
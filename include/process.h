@@ -37,30 +37,105 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
-#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fd_scanner.h"
+#include "proc_reader.h"
+#include "string_table.h"
 /*
 Basic class for Process representation
-It contains relevant attributes as shown below
+It contains relevant attributes as shown below. Strings are interned in a
+table shared by all processes, so a Process is a few plain values that are
+cheap to move and sort; the views returned by its accessors stay valid
+until the next CompactStrings().
 */
 class Process {
  public:
-  explicit Process(int pid);
+  Process(int pid, const ProcFiles& files, long system_uptime);
+  bool Update(const ProcFiles& files, long system_uptime, double interval);
+  void ExpireCgroup();
   int Pid() const;
-  std::string User() const;
-  std::string Command() const;
+  int ParentPid() const;
+  int LastCpu() const;
+  std::string_view Name() const;
+  long OwnJiffies() const;
+  long ChildrenJiffiesDelta() const;
+  long ReadBytes() const;
+  long WriteBytes() const;
+  float MinorFaultRate() const;
+  float MajorFaultRate() const;
+  float VoluntarySwitchRate() const;
+  float InvoluntarySwitchRate() const;
+  void SampleSchedStat(long now_ns) const;
+  float OnCpuShare() const;
+  float RunQueueShare() const;
+  bool CountFds(FdScanner& scanner, long deadline_ns) const;
+  const FdScanner::Counts& Fds() const;
+  float FdLimitShare() const;
+  long Uid() const;
+  std::string_view User() const;
+  std::string_view Command() const;
+  std::string_view Cgroup() const;
   float CpuUtilization() const;
-  std::string Ram() const;
+  long Ram() const;
+  long Rss() const;
   long int UpTime() const;
   bool operator<(Process const& a) const;
 
+  static StringTable& Strings();
+  static void CompactStrings(std::vector<Process>& processes);
+
  private:
   int pid_;
-  std::string command;
-  std::string user;
+  long uid{-1};
+  // Display-only fields are read on first use, so filtered out or
+  // off-screen processes never pay for them
+  mutable bool command_loaded{false};
+  mutable StringTable::Id command{StringTable::kEmpty};
+  mutable bool user_loaded{false};
+  mutable StringTable::Id user{StringTable::kEmpty};
+  mutable bool cgroup_loaded{false};
+  mutable StringTable::Id cgroup{StringTable::kEmpty};
+  // Scheduler statistics are only sampled for the rows on screen; shares
+  // of the time between two samples, -1 until there are two
+  mutable long run_ns{-1};
+  mutable long wait_ns{-1};
+  mutable long sched_sampled_ns{0};
+  mutable float on_cpu_share{-1};
+  mutable float run_queue_share{-1};
+  // Descriptor counts, or a failure to list them, are kept until the
+  // process shows activity again, as an idle process cannot open or close
+  // descriptors
+  mutable FdScanner::Counts fds;
+  mutable long fds_activity{-1};
+  int parent_pid{0};
+  int last_cpu{-1};
+  StringTable::Id name{StringTable::kEmpty};
+  // Clock ticks after boot at which the process started, tells a reused
+  // PID apart; -1 before the first sample
+  long start_time{-1};
   long uptime;
-  std::string ram;
+  long active_jiffies{0};
+  long children_jiffies{-1};
+  long children_jiffies_delta{0};
+  // Virtual size and resident set in MB
+  long ram{0};
+  long rss{0};
+  long read_bytes{0};
+  long write_bytes{0};
+  // Cumulative counters, -1 before the first sample, and their per second
+  // rates over the last scan interval
+  long minor_faults{-1};
+  long major_faults{-1};
+  long voluntary_switches{-1};
+  long involuntary_switches{-1};
+  float minor_fault_rate{0};
+  float major_fault_rate{0};
+  float voluntary_switch_rate{0};
+  float involuntary_switch_rate{0};
   float cpu_utilization;
   float CalculateCpuUtilization() const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -39,9 +39,13 @@
 
 class Processor {
  public:
-  float Utilization();
+  void Update();
+  float Utilization() const;
 
  private:
+  long previous_active_{0};
+  long previous_idle_{0};
+  float utilization_{0};
 };
 
 #endif
\ No newline at end of file
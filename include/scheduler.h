@@ -0,0 +1,101 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <poll.h>
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+/*
+Drift-free sampling clock built on timerfd
+Every metric class is refreshed on its own period, counted in base ticks.
+When collecting costs more than the configured share of a core, all periods
+are stretched until the cost falls back under the budget.
+Wait() also returns early, with no metric due, when a wake descriptor
+becomes readable or a signal arrives, so keyboard input and terminal
+resizes are handled without waiting for a tick.
+*/
+class Scheduler {
+ public:
+  enum Metric {
+    kCpu = 0,
+    kPressure,
+    kMemory,
+    kProcesses,
+    kCgroups,
+    kNetwork,
+    kNumMetrics
+  };
+
+  explicit Scheduler(
+      std::chrono::milliseconds tick = std::chrono::milliseconds(250),
+      float budget = 0.05);
+  ~Scheduler();
+  Scheduler(const Scheduler&) = delete;
+  Scheduler& operator=(const Scheduler&) = delete;
+
+  void Period(Metric metric, std::chrono::milliseconds period);
+  void WakeOn(int fd);
+  void Forget(int fd);
+  unsigned Wait();
+  void BeginCollection();
+  void EndCollection();
+  int Backoff() const;
+  static bool Due(unsigned metrics, Metric metric);
+  static unsigned All();
+
+ private:
+  int timer_fd_{-1};
+  std::vector<pollfd> fds_;
+  long tick_ns_;
+  float budget_;
+  float cost_{0};
+  int backoff_{1};
+  unsigned long ticks_{0};
+  // Metrics due after the last Wait(), 0 for early wakeups, and the tick
+  // of the last collection whose cost was sampled
+  unsigned due_{0};
+  unsigned long sampled_ticks_{0};
+  long collection_start_ns_{0};
+  std::array<unsigned long, kNumMetrics> period_ticks_{};
+  std::array<unsigned long, kNumMetrics> next_due_{};
+};
+
+#endif
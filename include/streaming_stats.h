@@ -0,0 +1,73 @@
+// PROJECT LICENSE
+//
+// This project was submitted by Xi Chen as part of the Nanodegree At Udacity.
+//
+// As part of Udacity Honor code, your submissions must be your own work, hence
+// submitting this project as yours will cause you to break the Udacity Honor
+// Code and the suspension of your account.
+//
+// Me, the author of the project, allow you to check the code as a reference,
+// but if you submit it, it's your own responsibility if you get expelled.
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Besides the above notice, the following license applies and this license
+// notice must be included in all works derived from this project.
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STREAMING_STATS_H
+#define STREAMING_STATS_H
+
+/*
+Constant memory statistics of one time series
+The mean and variance are exponentially weighted with a time constant, so
+samples taken at irregular intervals weigh by the time they cover. A
+single quantile is estimated with the P-square algorithm of Jain and
+Chlamtac, which keeps five markers instead of the samples themselves.
+*/
+class StreamingStats {
+ public:
+  StreamingStats(double quantile, double window_seconds);
+  void Add(double value, double seconds);
+  long Count() const;
+  double Seconds() const;
+  double Mean() const;
+  double Variance() const;
+  double StdDev() const;
+  double Quantile() const;
+
+ private:
+  double p_;
+  double window_;
+  long count_{0};
+  double seconds_{0};
+  double mean_{0};
+  double variance_{0};
+  // Marker heights, actual and desired positions
+  double heights_[5]{};
+  double positions_[5]{};
+  double desired_[5]{};
+  double Parabolic(int i, double d) const;
+  double Linear(int i, int d) const;
+};
+
+#endif
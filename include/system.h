@@ -37,29 +37,88 @@
 #ifndef SYSTEM_H
 #define SYSTEM_H
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
+#include "alerts.h"
+#include "arena.h"
+#include "exit_tracker.h"
+#include "fd_scanner.h"
+#include "network_traffic.h"
+#include "numa.h"
+#include "pid_set.h"
+#include "proc_reader.h"
 #include "process.h"
 #include "processor.h"
+#include "snapshot.h"
 
 class System {
  public:
-  System();
+  explicit System(ProcReader::Backend backend = ProcReader::kAuto,
+                  const std::vector<std::string>& alert_rules = {});
+  void Refresh(unsigned metrics);
   Processor& Cpu();
   std::vector<Process>& Processes();
   float MemoryUtilization();
+  float CpuPressure();
   long UpTime();
   int TotalProcesses();
   int RunningProcesses();
+  float ContextSwitchRate() const;
+  float MajorFaultRate() const;
+  float RunQueueDelay() const;
+  void SampleSchedStats(const std::vector<const Process*>& processes,
+                        std::size_t first, std::size_t count);
+  void CountFds(const std::vector<int>& shown);
+  const LinuxParser::FileHandles& OpenFiles() const;
   std::string Kernel();
   std::string OperatingSystem();
+  void TakeSnapshot(const std::string& host, std::size_t top,
+                    Snapshot& snapshot);
+  ExitTracker& Exits();
+  const Alerts& Alerting() const;
+  const NetworkTraffic& Network() const;
+  const NumaTopology& Numa() const;
+  const ProcReader& ProcScan() const;
+  const PidSet& Pids() const;
 
  private:
   Processor cpu_ = {};
+  ExitTracker exits_;
+  Alerts alerts_;
+  ProcReader reader_;
+  NetworkTraffic network_;
+  NumaTopology numa_;
+  FdScanner fd_scanner_;
+  // Processes by PID, kept to reuse its capacity
+  std::vector<const Process*> fd_order_;
+  // Where the next descriptor count resumes in the rows on screen and in
+  // the round-robin over all processes
+  std::size_t fd_next_shown_{0};
+  int fd_next_pid_{0};
+  LinuxParser::FileHandles open_files_;
   std::vector<Process> processes_ = {};
+  // Per scan working storage, kept to reuse its capacity
+  std::vector<Process> scratch_;
+  PidSet pids_;
+  Arena tick_;
   std::string kernel_;
   std::string os_;
+  float memory_utilization_{0};
+  float cpu_pressure_{0};
+  long uptime_{0};
+  int total_processes_{0};
+  int running_processes_{0};
+  long last_scan_ns_{0};
+  double scan_interval_{0};
+  long context_switches_{0};
+  long major_faults_{0};
+  float context_switch_rate_{0};
+  float major_fault_rate_{0};
+  long run_queue_delay_{-1};
+  float run_queue_delay_rate_{-1};
+  void UpdateProcesses();
 };
 
 #endif
\ No newline at end of file
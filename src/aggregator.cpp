@@ -0,0 +1,209 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "aggregator.h"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "format.h"
+#include "network.h"
+#include "protocol.h"
+#include "scheduler.h"
+
+namespace {
+// Fixed width column, truncated or padded with spaces
+std::string Column(std::string_view value, std::size_t width) {
+  std::string column(value.substr(0, width));
+  column.resize(width + 1, ' ');
+  return column;
+}
+}  // namespace
+
+Aggregator::Aggregator(const std::vector<std::string>& endpoints,
+                       std::size_t top)
+    : top_(top) {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    throw std::system_error(errno, std::generic_category(), "epoll_create1");
+  }
+  for (const std::string& endpoint : endpoints) {
+    Node node;
+    node.endpoint = endpoint;
+    nodes_.push_back(std::move(node));
+  }
+}
+
+Aggregator::~Aggregator() {
+  for (Node& node : nodes_) {
+    if (node.fd >= 0) close(node.fd);
+  }
+  close(epoll_fd_);
+}
+
+void Aggregator::Run() {
+  Scheduler scheduler;
+  scheduler.WakeOn(epoll_fd_);
+  std::vector<epoll_event> events(std::max<std::size_t>(64, nodes_.size()));
+  while (1) {
+    const unsigned due = scheduler.Wait();
+    if (Scheduler::Due(due, Scheduler::kProcesses)) {
+      for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        if (nodes_[i].fd < 0) Connect(i);
+      }
+      Print();
+    }
+    const int ready = epoll_wait(epoll_fd_, events.data(), events.size(), 0);
+    for (int i = 0; i < ready; ++i) {
+      const std::size_t index = events[i].data.u64;
+      if (events[i].events & EPOLLIN) {
+        Receive(index);
+      } else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+        Disconnect(index);
+      }
+    }
+  }
+}
+
+void Aggregator::Connect(std::size_t index) {
+  Node& node = nodes_[index];
+  try {
+    node.fd = Network::Connect(node.endpoint);
+  } catch (std::exception& e) {
+    node.fd = -1;
+  }
+  if (node.fd < 0) return;
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLRDHUP;
+  event.data.u64 = index;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, node.fd, &event);
+}
+
+// Drains the socket and decodes every complete frame; only the newest
+// snapshot of a node is kept. Reads stop at frame boundaries: the header is
+// read first and its length prefix sizes the buffer for the rest, so the
+// buffer never holds more than one frame.
+void Aggregator::Receive(std::size_t index) {
+  Node& node = nodes_[index];
+  try {
+    while (1) {
+      const std::size_t size = node.buffer.size();
+      const std::size_t frame =
+          Protocol::FrameSize(node.buffer.data(), node.buffer.size());
+      if (frame != 0 && size == frame) {
+        Protocol::Decode(node.buffer.data(), size, node.snapshot);
+        node.online = true;
+        node.buffer.clear();
+        continue;
+      }
+      const std::size_t wanted = frame == 0 ? Protocol::kHeaderSize : frame;
+      node.buffer.resize(wanted);
+      const ssize_t received = read(node.fd, &node.buffer[size], wanted - size);
+      node.buffer.resize(size + std::max<ssize_t>(received, 0));
+      if (received == 0 || (received < 0 && errno != EAGAIN)) {
+        Disconnect(index);
+        return;
+      }
+      if (received < 0) return;
+    }
+  } catch (std::exception& e) {
+    Disconnect(index);
+  }
+}
+
+void Aggregator::Disconnect(std::size_t index) {
+  Node& node = nodes_[index];
+  if (node.fd >= 0) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, node.fd, nullptr);
+    close(node.fd);
+  }
+  node.fd = -1;
+  node.online = false;
+  node.buffer.clear();
+}
+
+void Aggregator::Print() {
+  struct Row {
+    const Node* node;
+    const ProcessSample* process;
+  };
+  std::vector<Row> rows;
+  int online{0};
+  long processes{0};
+  for (const Node& node : nodes_) {
+    if (!node.online) continue;
+    ++online;
+    processes += node.snapshot.total_processes;
+    for (const ProcessSample& process : node.snapshot.processes) {
+      rows.push_back({&node, &process});
+    }
+  }
+  const std::size_t count = std::min(top_, rows.size());
+  std::partial_sort(rows.begin(), rows.begin() + count, rows.end(),
+                    [](const Row& a, const Row& b) {
+                      return a.process->cpu > b.process->cpu;
+                    });
+
+  output_.clear();
+  output_ += "Nodes: " + std::to_string(online) + "/" +
+             std::to_string(nodes_.size()) +
+             "  Total Processes: " + std::to_string(processes) + "\n";
+  output_ += Column("HOST", 20) + Column("CPU[%]", 7) + Column("MEM[%]", 7) +
+             Column("PROCS", 7) + "UP TIME\n";
+  for (const Node& node : nodes_) {
+    if (!node.online) {
+      output_ += Column(node.endpoint, 20) + "offline\n";
+      continue;
+    }
+    const Snapshot& snapshot = node.snapshot;
+    output_ += Column(snapshot.host, 20) +
+               Column(std::to_string(snapshot.cpu * 100).substr(0, 4), 7) +
+               Column(std::to_string(snapshot.memory * 100).substr(0, 4), 7) +
+               Column(std::to_string(snapshot.total_processes), 7) +
+               Format::ElapsedTime(snapshot.uptime) + "\n";
+  }
+  output_ += Column("HOST", 20) + Column("PID", 7) + Column("USER", 8) +
+             Column("CPU[%]", 7) + Column("RAM[MB]", 8) + Column("TIME+", 10) +
+             "COMMAND\n";
+  for (std::size_t i = 0; i < count; ++i) {
+    const ProcessSample& process = *rows[i].process;
+    output_ += Column(rows[i].node->snapshot.host, 20) +
+               Column(std::to_string(process.pid), 7) +
+               Column(process.user, 8) +
+               Column(std::to_string(process.cpu * 100).substr(0, 4), 7) +
+               Column(std::to_string(process.ram), 8) +
+               Column(Format::ElapsedTime(process.uptime), 10) +
+               std::string(process.command) + "\n";
+  }
+  output_ += "\n";
+  std::fwrite(output_.data(), 1, output_.size(), stdout);
+  std::fflush(stdout);
+}
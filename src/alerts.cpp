@@ -0,0 +1,253 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "alerts.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+// Samples a quantile rule needs before its estimate is trusted
+const long kWarmUpSamples{30};
+
+// "90s", "5m" or "1h" in seconds
+double Duration(const std::string& text) {
+  std::size_t end{0};
+  const double value = std::stod(text, &end);
+  const std::string unit = text.substr(end);
+  if (unit == "s" || unit.empty()) return value;
+  if (unit == "m") return value * 60;
+  if (unit == "h") return value * 3600;
+  throw std::invalid_argument("bad duration: " + text);
+}
+}  // namespace
+
+// Throws std::invalid_argument for malformed rules
+Alerts::Alerts(const std::vector<std::string>& rules) {
+  std::size_t slots[2]{};
+  for (const std::string& rule : rules) {
+    rules_.push_back(Parse(rule));
+    rules_.back().slot = slots[rules_.back().system]++;
+  }
+  system_ = NewSeries(true);
+}
+
+Alerts::Rule Alerts::Parse(const std::string& text) {
+  Rule rule;
+  rule.text = text;
+  std::istringstream stream(text);
+  std::string word;
+  stream >> word;
+  if (word == "system") {
+    rule.system = true;
+    stream >> word;
+  }
+  if (word == "cpu") {
+    rule.metric = kCpu;
+  } else if (word == "ram" && !rule.system) {
+    rule.metric = kRam;
+  } else if (word == "io" && !rule.system) {
+    rule.metric = kIo;
+  } else if (word == "memory" && rule.system) {
+    rule.metric = kMemory;
+  } else if (word == "pressure" && rule.system) {
+    rule.metric = kPressure;
+  } else {
+    throw std::invalid_argument("unknown metric in alert rule: " + text);
+  }
+  try {
+    stream >> word;
+    if (word == "grows") {
+      rule.kind = kGrowth;
+      stream >> word;
+      if (word.empty() || word.back() != '%') throw std::invalid_argument("");
+      rule.threshold = std::stod(word);
+      stream >> word;
+      if (word != "over") throw std::invalid_argument("");
+      stream >> word;
+      rule.window = Duration(word);
+    } else if (word == ">") {
+      stream >> word;
+      if (word.size() > 1 && word[0] == 'p') {
+        rule.kind = kQuantile;
+        rule.quantile = std::stod(word.substr(1)) / 100;
+        if (rule.quantile <= 0 || rule.quantile >= 1) {
+          throw std::invalid_argument("");
+        }
+        while (stream >> word) {
+          if (word == "+") {
+            stream >> word;
+            const std::size_t sigma = word.find("sigma");
+            if (sigma == std::string::npos) throw std::invalid_argument("");
+            rule.sigmas = std::stod(word.substr(0, sigma));
+          } else if (word == "over") {
+            stream >> word;
+            rule.window = Duration(word);
+          } else {
+            throw std::invalid_argument("");
+          }
+        }
+      } else {
+        rule.threshold = std::stod(word);
+      }
+    } else {
+      throw std::invalid_argument("");
+    }
+  } catch (const std::logic_error&) {
+    throw std::invalid_argument("bad alert rule: " + text);
+  }
+  if (stream >> word) throw std::invalid_argument("bad alert rule: " + text);
+  return rule;
+}
+
+// Statistics for the system rules or for the process rules
+Alerts::Series Alerts::NewSeries(bool system) const {
+  Series series;
+  for (const Rule& rule : rules_) {
+    if (rule.system == system) {
+      series.stats.emplace_back(rule.quantile, rule.window);
+    }
+  }
+  series.rule_firing.resize(series.stats.size(), false);
+  return series;
+}
+
+void Alerts::Update(const std::vector<Process>& processes, float cpu,
+                    float memory, float pressure) {
+  const long now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                       .count();
+  const double seconds =
+      last_update_ns_ > 0 ? (now - last_update_ns_) / 1e9 : 0;
+  last_update_ns_ = now;
+  firing_.clear();
+  started_.clear();
+  resolved_.clear();
+  if (rules_.empty()) return;
+
+  const double hertz = sysconf(_SC_CLK_TCK);
+  const double unknown = std::nan("");
+  ++generation_;
+  for (const Process& process : processes) {
+    auto known = processes_.find(process.Pid());
+    if (known == processes_.end()) {
+      known = processes_.emplace(process.Pid(), NewSeries(false)).first;
+    }
+    Series& series = known->second;
+    series.generation = generation_;
+    // Jiffies of reaped children arrive in bursts and are left out
+    const long jiffies = process.OwnJiffies();
+    const long io = process.ReadBytes() + process.WriteBytes();
+    // ram rules watch the resident set; the virtual size also grows with
+    // address space that is only reserved, such as thread stacks
+    double values[5] = {unknown, double(process.Rss()), unknown, unknown,
+                        unknown};
+    if (series.jiffies >= 0 && seconds > 0) {
+      values[kCpu] = (jiffies - series.jiffies) / hertz / seconds * 100;
+      values[kIo] = (io - series.io) / 1024.0 / seconds;
+    }
+    series.jiffies = jiffies;
+    series.io = io;
+    Evaluate(series, &process, values, seconds);
+  }
+  // Series of exited processes are dropped, their alerts resolve
+  for (auto it = processes_.begin(); it != processes_.end();) {
+    if (it->second.generation == generation_) {
+      ++it;
+      continue;
+    }
+    for (const Rule& rule : rules_) {
+      if (!rule.system && it->second.rule_firing[rule.slot]) {
+        resolved_.push_back({it->first, "(exited)", &rule.text, 0, 0});
+      }
+    }
+    it = processes_.erase(it);
+  }
+  const double system[5] = {cpu * 100.0, unknown, unknown, memory * 100.0,
+                            pressure * 100.0};
+  Evaluate(system_, nullptr, system, seconds);
+}
+
+// Every sample is compared with the statistics of the samples before it,
+// then added to them
+void Alerts::Evaluate(Series& series, const Process* process,
+                      const double (&values)[5], double seconds) {
+  series.firing = false;
+  for (const Rule& rule : rules_) {
+    if (rule.system != (process == nullptr)) continue;
+    const double value = values[rule.metric];
+    if (std::isnan(value)) continue;
+    const std::size_t i = rule.slot;
+    StreamingStats& stats = series.stats[i];
+    double limit{0};
+    bool firing{false};
+    switch (rule.kind) {
+      case kAbove:
+        limit = rule.threshold;
+        firing = value > limit;
+        break;
+      case kQuantile:
+        limit = stats.Quantile() + rule.sigmas * stats.StdDev();
+        firing = stats.Count() >= kWarmUpSamples && value > limit;
+        break;
+      case kGrowth:
+        limit = stats.Mean() * (1 + rule.threshold / 100);
+        firing = stats.Seconds() >= rule.window && stats.Mean() > 0 &&
+                 value > limit;
+        break;
+    }
+    stats.Add(value, seconds);
+    if (firing == series.rule_firing[i] && !firing) continue;
+    Alert alert;
+    alert.pid = process != nullptr ? process->Pid() : 0;
+    alert.subject =
+        process != nullptr ? std::string(process->Name()) : "system";
+    alert.rule = &rule.text;
+    alert.value = value;
+    alert.limit = limit;
+    if (firing && !series.rule_firing[i]) started_.push_back(alert);
+    if (!firing) resolved_.push_back(alert);
+    if (firing) firing_.push_back(alert);
+    series.rule_firing[i] = firing;
+    series.firing |= firing;
+  }
+}
+
+bool Alerts::Firing(int pid) const {
+  auto known = processes_.find(pid);
+  return known != processes_.end() && known->second.firing;
+}
+
+const std::vector<Alerts::Alert>& Alerts::Firing() const { return firing_; }
+
+const std::vector<Alerts::Alert>& Alerts::Started() const { return started_; }
+
+const std::vector<Alerts::Alert>& Alerts::Resolved() const {
+  return resolved_;
+}
@@ -0,0 +1,60 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "arena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+Arena::Arena(std::size_t block_size) : block_size_(block_size) {}
+
+// Moves on to the next block when the current one is full; a request larger
+// than the block size gets a block of its own
+void* Arena::Allocate(std::size_t size, std::size_t alignment) {
+  while (block_ < blocks_.size()) {
+    Block& block = blocks_[block_];
+    const std::size_t offset = (used_ + alignment - 1) & ~(alignment - 1);
+    if (offset + size <= block.size) {
+      used_ = offset + size;
+      return block.data.get() + offset;
+    }
+    ++block_;
+    used_ = 0;
+  }
+  const std::size_t block_size = std::max(block_size_, size + alignment);
+  blocks_.push_back({std::make_unique<char[]>(block_size), block_size});
+  return Allocate(size, alignment);
+}
+
+std::string_view Arena::Copy(std::string_view text) {
+  if (text.empty()) return {};
+  char* copy = Allocate<char>(text.size());
+  std::memcpy(copy, text.data(), text.size());
+  return std::string_view(copy, text.size());
+}
+
+void Arena::Reset() {
+  block_ = 0;
+  used_ = 0;
+}
@@ -0,0 +1,179 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "collector.h"
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "network.h"
+#include "protocol.h"
+#include "scheduler.h"
+#include "snapshot.h"
+
+Collector::Collector(System& system, const std::string& endpoint,
+                     const std::string& metrics_endpoint, std::string host,
+                     std::size_t top)
+    : system_(system), host_(std::move(host)), top_(top) {
+  if (!endpoint.empty()) listen_fd_ = Network::Listen(endpoint);
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    if (listen_fd_ >= 0) close(listen_fd_);
+    throw std::system_error(errno, std::generic_category(), "epoll_create1");
+  }
+  if (listen_fd_ >= 0) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listen_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event);
+  }
+  try {
+    if (!metrics_endpoint.empty()) {
+      metrics_ = std::make_unique<MetricsServer>(metrics_endpoint);
+    }
+  } catch (...) {
+    close(epoll_fd_);
+    if (listen_fd_ >= 0) close(listen_fd_);
+    throw;
+  }
+}
+
+Collector::~Collector() {
+  for (auto& client : clients_) close(client.first);
+  close(epoll_fd_);
+  if (listen_fd_ >= 0) close(listen_fd_);
+}
+
+void Collector::Run() {
+  Scheduler scheduler;
+  scheduler.WakeOn(epoll_fd_);
+  if (metrics_) scheduler.WakeOn(metrics_->EventFd());
+  while (1) {
+    const unsigned due = scheduler.Wait();
+    scheduler.BeginCollection();
+    system_.Refresh(due);
+    scheduler.EndCollection();
+    if (Scheduler::Due(due, Scheduler::kProcesses)) {
+      Publish();
+      ReportAlerts();
+    }
+    if (metrics_) metrics_->Poll();
+
+    epoll_event events[64];
+    const int ready = epoll_wait(epoll_fd_, events, 64, 0);
+    for (int i = 0; i < ready; ++i) {
+      const int fd = events[i].data.fd;
+      if (fd == listen_fd_) {
+        Accept();
+        continue;
+      }
+      auto client = clients_.find(fd);
+      if (client == clients_.end()) continue;
+      // Aggregators never send anything, so readable means closed
+      if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP) ||
+          !Flush(fd, client->second)) {
+        Drop(fd);
+      }
+    }
+  }
+}
+
+void Collector::Accept() {
+  while (1) {
+    const int fd = accept4(listen_fd_, nullptr, nullptr,
+                           SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) return;
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.fd = fd;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+    clients_[fd];
+  }
+}
+
+// Headless output: one line per alert that started or resolved this tick
+void Collector::ReportAlerts() {
+  const Alerts& alerts = system_.Alerting();
+  for (const Alerts::Alert& alert : alerts.Started()) {
+    std::printf("%s alert firing: %s (%d): %s, %.1f > %.1f\n", host_.c_str(),
+                alert.subject.c_str(), alert.pid, alert.rule->c_str(),
+                alert.value, alert.limit);
+  }
+  for (const Alerts::Alert& alert : alerts.Resolved()) {
+    std::printf("%s alert resolved: %s (%d): %s\n", host_.c_str(),
+                alert.subject.c_str(), alert.pid, alert.rule->c_str());
+  }
+  if (!alerts.Started().empty() || !alerts.Resolved().empty()) {
+    std::fflush(stdout);
+  }
+}
+
+void Collector::Publish() {
+  system_.TakeSnapshot(host_, top_, snapshot_);
+  if (metrics_) metrics_->Update(snapshot_);
+  if (clients_.empty()) return;
+  Protocol::Encode(snapshot_, frame_);
+  for (auto it = clients_.begin(); it != clients_.end();) {
+    Client& client = it->second;
+    const int fd = it->first;
+    ++it;
+    if (client.sent < client.pending.size()) continue;
+    client.pending.assign(frame_);
+    client.sent = 0;
+    if (!Flush(fd, client)) Drop(fd);
+  }
+}
+
+// Writes as much of the pending frame as the socket takes and only asks
+// for writability while a remainder is left. Returns false on errors.
+bool Collector::Flush(int fd, Client& client) {
+  while (client.sent < client.pending.size()) {
+    const ssize_t written =
+        send(fd, client.pending.data() + client.sent,
+             client.pending.size() - client.sent, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+      break;
+    }
+    client.sent += written;
+  }
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLRDHUP;
+  if (client.sent < client.pending.size()) event.events |= EPOLLOUT;
+  event.data.fd = fd;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event);
+  return true;
+}
+
+void Collector::Drop(int fd) {
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  close(fd);
+  clients_.erase(fd);
+}
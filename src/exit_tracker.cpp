@@ -0,0 +1,215 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "exit_tracker.h"
+
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <linux_parser.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+const std::string kCommFilename{"/comm"};
+const std::string kUnknownCommand{"?"};
+
+std::string Comm(int pid) {
+  std::string comm;
+  std::ifstream stream(LinuxParser::ProcDirectory() + std::to_string(pid) +
+                       kCommFilename);
+  if (stream.is_open()) std::getline(stream, comm);
+  return comm;
+}
+}  // namespace
+
+ExitTracker::~ExitTracker() { Enable(false); }
+
+void ExitTracker::Enable(bool enable) {
+  if (enable && !enabled_) Subscribe();
+  if (!enable && event_fd_ >= 0) {
+    close(event_fd_);
+    event_fd_ = -1;
+  }
+  if (!enable) {
+    children_.clear();
+    exited_.clear();
+    reaped_.clear();
+    exits_.clear();
+  }
+  enabled_ = enable;
+}
+
+bool ExitTracker::Enabled() const { return enabled_; }
+
+// True while exits come from the kernel instead of scan differences
+bool ExitTracker::Events() const { return event_fd_ >= 0; }
+
+int ExitTracker::EventFd() const { return event_fd_; }
+
+// Joins the proc connector multicast group. This needs CAP_NET_ADMIN, so
+// failing here is expected and only disables the event stream.
+void ExitTracker::Subscribe() {
+  const int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        NETLINK_CONNECTOR);
+  if (fd < 0) return;
+  sockaddr_nl address{};
+  address.nl_family = AF_NETLINK;
+  address.nl_groups = CN_IDX_PROC;
+  alignas(nlmsghdr) char request[NLMSG_SPACE(sizeof(cn_msg) +
+                                             sizeof(proc_cn_mcast_op))] = {};
+  nlmsghdr* header = reinterpret_cast<nlmsghdr*>(request);
+  header->nlmsg_len = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_cn_mcast_op));
+  header->nlmsg_type = NLMSG_DONE;
+  cn_msg* message = static_cast<cn_msg*>(NLMSG_DATA(header));
+  message->id.idx = CN_IDX_PROC;
+  message->id.val = CN_VAL_PROC;
+  message->len = sizeof(proc_cn_mcast_op);
+  *reinterpret_cast<proc_cn_mcast_op*>(message->data) = PROC_CN_MCAST_LISTEN;
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+      send(fd, request, header->nlmsg_len, 0) < 0) {
+    close(fd);
+    return;
+  }
+  event_fd_ = fd;
+}
+
+// Drains pending process events. Called on every wake up, because the
+// command name of a short-lived process can only be read while it runs.
+void ExitTracker::Poll() {
+  if (event_fd_ < 0) return;
+  alignas(nlmsghdr) char buffer[8192];
+  while (1) {
+    const ssize_t received = recv(event_fd_, buffer, sizeof(buffer), 0);
+    if (received <= 0) return;
+    int size = received;
+    for (nlmsghdr* header = reinterpret_cast<nlmsghdr*>(buffer);
+         NLMSG_OK(header, size); header = NLMSG_NEXT(header, size)) {
+      if (header->nlmsg_type != NLMSG_DONE) continue;
+      const cn_msg* message = static_cast<const cn_msg*>(NLMSG_DATA(header));
+      Handle(message->data);
+    }
+  }
+}
+
+void ExitTracker::Handle(const void* data) {
+  const proc_event* event = static_cast<const proc_event*>(data);
+  switch (event->what) {
+    case proc_event::PROC_EVENT_FORK: {
+      const auto& fork = event->event_data.fork;
+      if (fork.child_pid != fork.child_tgid) return;  // a new thread
+      Child& child = children_[fork.child_tgid];
+      child.parent_pid = fork.parent_tgid;
+      child.command = Comm(fork.child_tgid);
+      break;
+    }
+    case proc_event::PROC_EVENT_EXEC: {
+      const int pid = event->event_data.exec.process_tgid;
+      const std::string comm = Comm(pid);
+      if (!comm.empty()) children_[pid].command = comm;
+      break;
+    }
+    case proc_event::PROC_EVENT_EXIT: {
+      const auto& exit = event->event_data.exit;
+      if (exit.process_pid != exit.process_tgid) return;
+      auto child = children_.find(exit.process_tgid);
+      if (child != children_.end()) {
+        exited_[exit.process_tgid] = child->second;
+        children_.erase(child);
+      } else {
+        exited_[exit.process_tgid];
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+// A scanned process is gone. With the event stream this only contributes
+// the name and parent, which the stream may not know for older processes.
+void ExitTracker::Exited(const Process& process) {
+  if (!enabled_) return;
+  if (Events() && exited_.find(process.Pid()) == exited_.end()) return;
+  Child& child = exited_[process.Pid()];
+  if (child.command.empty()) child.command = process.Name();
+  if (child.parent_pid == 0) child.parent_pid = process.ParentPid();
+}
+
+void ExitTracker::Reaped(const Process& parent) {
+  if (!enabled_ || parent.ChildrenJiffiesDelta() <= 0) return;
+  reaped_[parent.Pid()] = {std::string(parent.Name()),
+                           parent.ChildrenJiffiesDelta()};
+}
+
+// Folds the exits and reaped CPU of the finished tick into a summary per
+// command name, most expensive first
+void ExitTracker::EndTick() {
+  if (!enabled_) return;
+  std::map<std::string, Summary> summary;
+  std::unordered_map<int, std::vector<const std::string*>> by_parent;
+  for (const auto& exit : exited_) {
+    const std::string& command = exit.second.command.empty()
+                                     ? kUnknownCommand
+                                     : exit.second.command;
+    Summary& entry = summary[command];
+    entry.command = command;
+    ++entry.count;
+    by_parent[exit.second.parent_pid].push_back(&entry.command);
+  }
+  for (const auto& parent : reaped_) {
+    const long jiffies = parent.second.second;
+    auto children = by_parent.find(parent.first);
+    if (children == by_parent.end()) {
+      // Children that forked and exited between two event drains or scans
+      const std::string command = "(children of " + parent.second.first + ")";
+      Summary& entry = summary[command];
+      entry.command = command;
+      entry.jiffies += jiffies;
+      continue;
+    }
+    const long share = jiffies / children->second.size();
+    for (const std::string* command : children->second) {
+      summary[*command].jiffies += share;
+    }
+  }
+  exits_.clear();
+  for (auto& entry : summary) exits_.push_back(entry.second);
+  std::sort(exits_.begin(), exits_.end(),
+            [](const Summary& a, const Summary& b) {
+              return a.jiffies != b.jiffies ? a.jiffies > b.jiffies
+                                            : a.count > b.count;
+            });
+  exited_.clear();
+  reaped_.clear();
+}
+
+const std::vector<ExitTracker::Summary>& ExitTracker::Exits() const {
+  return exits_;
+}
@@ -0,0 +1,124 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "fd_scanner.h"
+
+#include <fcntl.h>
+#include <linux_parser.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "directory_entries.h"
+#include "keyed_fields.h"
+
+namespace {
+const std::size_t kBufferSize{32768};
+const std::size_t kPathSize{256};
+const std::size_t kLinkSize{64};
+// Entries listed between two looks at the clock
+const int kDeadlineStride{64};
+const std::string_view kMaxOpenFiles{"Max open files"};
+
+long Now() {
+  timespec now{};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+
+bool StartsWith(const char* link, ssize_t length, const char* prefix) {
+  const std::size_t size = std::strlen(prefix);
+  return static_cast<std::size_t>(length) >= size &&
+         std::memcmp(link, prefix, size) == 0;
+}
+
+// Soft limit column of the "Max open files" line of /proc/[pid]/limits,
+// which is readable under --proc-root unlike prlimit(2) on the local PID
+long OpenFilesLimit(const char* path) {
+  KeyedFields::LineReader reader(path);
+  std::string_view line;
+  while (reader.Next(line)) {
+    if (line.substr(0, kMaxOpenFiles.size()) != kMaxOpenFiles) continue;
+    const char* begin = line.data() + kMaxOpenFiles.size();
+    const char* const end = line.data() + line.size();
+    while (begin < end && *begin == ' ') ++begin;
+    // "unlimited" has no digits
+    if (begin == end || *begin < '0' || *begin > '9') return -1;
+    return KeyedFields::ParseLong(begin, end);
+  }
+  return -1;
+}
+}  // namespace
+
+FdScanner::FdScanner() : buffer_(kBufferSize) {}
+
+// Counts are only replaced on kCounted. kDenied means the directory may
+// not be read, because the process exited or belongs to another user;
+// kTimedOut that deadline_ns passed before the listing was done.
+FdScanner::Result FdScanner::Count(int pid, long deadline_ns,
+                                   Counts& counts) {
+  char path[kPathSize];
+  std::snprintf(path, sizeof(path), "%s%d/fd",
+                LinuxParser::ProcDirectory().c_str(), pid);
+  const int directory = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (directory < 0) return Result::kDenied;
+  Counts result;
+  result.total = 0;
+  char link[kLinkSize];
+  int stride{0};
+  bool timed_out{false};
+  DirectoryEntries::ForEach(
+      directory, buffer_, [&](const char* name, unsigned char) {
+        if (++stride == kDeadlineStride) {
+          stride = 0;
+          if (Now() >= deadline_ns) {
+            timed_out = true;
+            return false;
+          }
+        }
+        if (name[0] == '.') return true;
+        ++result.total;
+        // Targets are truncated, only their prefix matters
+        const ssize_t length = readlinkat(directory, name, link, sizeof(link));
+        if (length <= 0) return true;
+        if (link[0] == '/') {
+          ++result.files;
+        } else if (StartsWith(link, length, "socket:")) {
+          ++result.sockets;
+        } else if (StartsWith(link, length, "pipe:")) {
+          ++result.pipes;
+        }
+        return true;
+      });
+  close(directory);
+  if (timed_out) return Result::kTimedOut;
+  std::snprintf(path, sizeof(path), "%s%d/limits",
+                LinuxParser::ProcDirectory().c_str(), pid);
+  result.limit = OpenFilesLimit(path);
+  counts = result;
+  return Result::kCounted;
+}
@@ -0,0 +1,116 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "filter.h"
+
+#include <linux_parser.h>
+
+#include <algorithm>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// Throws std::invalid_argument or std::regex_error for malformed terms
+Filter::Filter(const std::string& query) : query_(query) {
+  std::istringstream query_stream(query);
+  std::string term;
+  while (query_stream >> term) {
+    Compile(term);
+  }
+  std::stable_sort(
+      terms_.begin(), terms_.end(),
+      [](const Term& a, const Term& b) { return a.cost < b.cost; });
+}
+
+void Filter::Compile(const std::string& term) {
+  const std::size_t colon = term.find(':');
+  const std::size_t comparison = term.find_first_of("<>");
+  if (comparison != std::string::npos && colon == std::string::npos) {
+    const std::string field = term.substr(0, comparison);
+    const bool above = term[comparison] == '>';
+    const float limit = std::stof(term.substr(comparison + 1));
+    if (field == "cpu") {
+      terms_.push_back({kCached, [above, limit](const Process& process) {
+                          const float cpu = process.CpuUtilization() * 100;
+                          return above ? cpu > limit : cpu < limit;
+                        }});
+      return;
+    }
+    if (field == "ram") {
+      terms_.push_back({kCached, [above, limit](const Process& process) {
+                          const float ram = process.Ram();
+                          return above ? ram > limit : ram < limit;
+                        }});
+      return;
+    }
+    throw std::invalid_argument("unknown field: " + field);
+  }
+
+  const std::string key =
+      colon == std::string::npos ? "cmd" : term.substr(0, colon);
+  const std::string value =
+      colon == std::string::npos ? term : term.substr(colon + 1);
+  if (key == "user") {
+    // Resolved to a UID once, so no passwd lookups happen per process
+    const std::string name = LinuxParser::Uid(value);
+    const long uid = name.empty() ? -1 : std::stol(name);
+    terms_.push_back({kCached, [uid](const Process& process) {
+                        return uid >= 0 && process.Uid() == uid;
+                      }});
+  } else if (key == "cmd") {
+    terms_.push_back({kFile, [value](const Process& process) {
+                        return process.Command().find(value) !=
+                               std::string_view::npos;
+                      }});
+  } else if (key == "re") {
+    const std::regex pattern(value, std::regex::optimize);
+    terms_.push_back({kFile, [pattern](const Process& process) {
+                        const std::string_view command = process.Command();
+                        return std::regex_search(command.begin(),
+                                                 command.end(), pattern);
+                      }});
+  } else if (key == "cgroup") {
+    terms_.push_back({kFile, [value](const Process& process) {
+                        return process.Cgroup().find(value) !=
+                               std::string_view::npos;
+                      }});
+  } else {
+    throw std::invalid_argument("unknown field: " + key);
+  }
+}
+
+bool Filter::Empty() const { return terms_.empty(); }
+
+std::string Filter::Query() const { return query_; }
+
+bool Filter::Matches(const Process& process) const {
+  for (const Term& term : terms_) {
+    try {
+      if (!term.matches(process)) return false;
+    } catch (std::exception& e) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -22,6 +22,7 @@
 
 #include "format.h"
 
+#include <cstdio>
 #include <iomanip>
 #include <string>
 
@@ -36,4 +37,17 @@ std::string Format::Padding(long number) {
   std::stringstream stream;
   stream << std::setw(2) << std::setfill('0') << number;
   return stream.str();
-}
\ No newline at end of file
+}
+// Scaled with binary prefixes, e.g. "12.3M" for 12.3 MiB per second
+std::string Format::Rate(float per_second) {
+  const char* const units{" KMGT"};
+  int unit{0};
+  while (per_second >= 1024 && unit < 4) {
+    per_second /= 1024;
+    ++unit;
+  }
+  char text[16];
+  std::snprintf(text, sizeof(text), unit > 0 ? "%.1f%c" : "%.0f%c",
+                per_second, units[unit]);
+  return text;
+}
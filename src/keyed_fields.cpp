@@ -0,0 +1,111 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "keyed_fields.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+// First integer after the separator, e.g. "  8167848 kB" or "1000\t1000"
+long KeyedFields::ParseLong(const char* begin, const char* end) {
+  while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+  bool negative{false};
+  if (begin < end && *begin == '-') {
+    negative = true;
+    ++begin;
+  }
+  long value{0};
+  while (begin < end && *begin >= '0' && *begin <= '9') {
+    value = value * 10 + (*begin++ - '0');
+  }
+  return negative ? -value : value;
+}
+
+// Value without surrounding blanks and quotes, e.g. "Ubuntu 20.04 LTS"
+std::string KeyedFields::ParseString(const char* begin, const char* end) {
+  while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '"')) {
+    ++begin;
+  }
+  while (end > begin && (end[-1] == ' ' || end[-1] == '\t' ||
+                         end[-1] == '"' || end[-1] == '\r')) {
+    --end;
+  }
+  return std::string(begin, end);
+}
+
+std::size_t KeyedFields::Read(int fd, char* buffer, std::size_t size) {
+  ssize_t received;
+  do {
+    received = read(fd, buffer, size);
+  } while (received < 0 && errno == EINTR);
+  return received > 0 ? received : 0;
+}
+
+int KeyedFields::Open(const std::string& path) {
+  return open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+void KeyedFields::Close(int fd) { close(fd); }
+
+KeyedFields::LineReader::LineReader(const std::string& path)
+    : fd_(Open(path)), end_of_file_(fd_ < 0) {}
+
+KeyedFields::LineReader::~LineReader() {
+  if (fd_ >= 0) Close(fd_);
+}
+
+bool KeyedFields::LineReader::Next(std::string_view& line) {
+  while (!(end_of_file_ && line_ >= size_)) {
+    const char* begin = buffer_ + line_;
+    const char* newline =
+        static_cast<const char*>(std::memchr(begin, '\n', size_ - line_));
+    if (newline == nullptr && !end_of_file_) {
+      // Keep the partial line and read more behind it
+      std::memmove(buffer_, begin, size_ - line_);
+      size_ -= line_;
+      line_ = 0;
+      if (size_ == sizeof(buffer_)) {
+        size_ = 0;
+        overlong_ = true;
+      }
+      const std::size_t received =
+          Read(fd_, buffer_ + size_, sizeof(buffer_) - size_);
+      end_of_file_ = received == 0;
+      size_ += received;
+      continue;
+    }
+    const char* end = newline != nullptr ? newline : buffer_ + size_;
+    line_ = end - buffer_ + 1;
+    if (overlong_) {
+      overlong_ = false;
+      continue;
+    }
+    line = std::string_view(begin, end - begin);
+    return true;
+  }
+  return false;
+}
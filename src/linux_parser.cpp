@@ -25,37 +25,116 @@
 #include <dirent.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <charconv>
 #include <string>
 #include <vector>
 
+#include "keyed_fields.h"
+
+namespace {
+std::string proc_directory{"/proc/"};
+
+// Files read on every refresh, joined once instead of on each read
+struct SystemPaths {
+  explicit SystemPaths(const std::string& directory)
+      : stat(directory + LinuxParser::kStatFilename),
+        schedstat(directory + LinuxParser::kSchedstatFilename),
+        file_nr(directory + LinuxParser::kFileNrFilename),
+        meminfo(directory + LinuxParser::kMeminfoFilename),
+        vmstat(directory + LinuxParser::kVmstatFilename),
+        uptime(directory + LinuxParser::kUptimeFilename),
+        pressure_cpu(directory + LinuxParser::kPressureCpuFilename) {}
+  std::string stat;
+  std::string schedstat;
+  std::string file_nr;
+  std::string meminfo;
+  std::string vmstat;
+  std::string uptime;
+  std::string pressure_cpu;
+};
+SystemPaths system_paths{proc_directory};
+
+// Parses the blank separated number at begin into value and returns the
+// position behind it
+const char* NextLong(const char* begin, const char* end, long& value) {
+  while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+  value = KeyedFields::ParseLong(begin, end);
+  while (begin < end && *begin != ' ' && *begin != '\t') ++begin;
+  return begin;
+}
+
+// Busy and idle time from the fields behind the name of a "cpu" line
+LinuxParser::CpuJiffies ParseCpuJiffies(const char* begin, const char* end) {
+  using namespace LinuxParser;
+  long times[kGuest_]{};
+  for (long& time : times) begin = NextLong(begin, end, time);
+  return {times[kUser_] + times[kNice_] + times[kSystem_] + times[kIRQ_] +
+              times[kSoftIRQ_] + times[kSteal_],
+          times[kIdle_] + times[kIOwait_]};
+}
+
+using LinuxParser::MemInfo;
+using LinuxParser::OsRelease;
+using LinuxParser::ProcessIo;
+using LinuxParser::ProcessStatus;
+
+constexpr KeyedFields::Field<MemInfo> kMemInfoSchema[] = {
+    {"MemTotal", &MemInfo::total}, {"MemFree", &MemInfo::free}};
+
+constexpr KeyedFields::Field<ProcessStatus> kProcessStatusSchema[] = {
+    {"Uid", &ProcessStatus::uid},
+    {"VmSize", &ProcessStatus::vm_size},
+    {"voluntary_ctxt_switches", &ProcessStatus::voluntary_switches},
+    {"nonvoluntary_ctxt_switches", &ProcessStatus::involuntary_switches}};
+
+// Single counters of /proc/stat and /proc/vmstat, "key value" lines
+struct Counter {
+  long value{0};
+};
+
+constexpr KeyedFields::Field<Counter> kContextSwitchesSchema[] = {
+    {"ctxt", &Counter::value}};
+
+constexpr KeyedFields::Field<Counter> kMajorFaultsSchema[] = {
+    {"pgmajfault", &Counter::value}};
+
+constexpr KeyedFields::Field<Counter> kTotalProcessesSchema[] = {
+    {"processes", &Counter::value}};
+
+constexpr KeyedFields::Field<Counter> kRunningProcessesSchema[] = {
+    {"procs_running", &Counter::value}};
+
+constexpr KeyedFields::Field<ProcessIo> kProcessIoSchema[] = {
+    {"read_bytes", &ProcessIo::read_bytes},
+    {"write_bytes", &ProcessIo::write_bytes}};
+
+constexpr KeyedFields::Field<OsRelease, std::string> kOsReleaseSchema[] = {
+    {"PRETTY_NAME", &OsRelease::pretty_name}};
+}  // namespace
+
+const std::string& LinuxParser::ProcDirectory() { return proc_directory; }
+
+// Lets a collector read a fixture tree instead of the live /proc
+void LinuxParser::SetProcDirectory(const std::string& directory) {
+  proc_directory = directory;
+  if (proc_directory.empty() || proc_directory.back() != '/') {
+    proc_directory += '/';
+  }
+  system_paths = SystemPaths(proc_directory);
+}
+
 // DONE: An example of how to read data from the filesystem
 std::string LinuxParser::OperatingSystem() {
-  std::string line;
-  std::string key;
-  std::string value = "";
-  std::ifstream filestream(kOSPath);
-  if (filestream.is_open()) {
-    while (std::getline(filestream, line)) {
-      std::replace(line.begin(), line.end(), ' ', '_');
-      std::replace(line.begin(), line.end(), '=', ' ');
-      std::replace(line.begin(), line.end(), '"', ' ');
-      std::istringstream linestream(line);
-      while (linestream >> key >> value) {
-        if (key == "PRETTY_NAME") {
-          std::replace(value.begin(), value.end(), '_', ' ');
-          return value;
-        }
-      }
-    }
-    return value;
-  }
-  return "";
+  OsRelease release;
+  KeyedFields::Scan(kOSPath, '=', kOsReleaseSchema, release);
+  return release.pretty_name;
 }
 
 // DONE: An example of how to read data from the filesystem
 std::string LinuxParser::Kernel() {
   std::string line;
-  std::ifstream stream(kProcDirectory + kVersionFilename);
+  std::ifstream stream(ProcDirectory() + kVersionFilename);
   if (stream.is_open()) {
     std::getline(stream, line);
     std::istringstream linestream(line);
@@ -67,20 +146,22 @@ std::string LinuxParser::Kernel() {
 }
 
 // BONUS: Update this to use std::filesystem
+// One-off listing; the process scan tracks PIDs with a PidSet
 std::vector<int> LinuxParser::Pids() {
   std::vector<int> pids;
-  DIR* directory = opendir(kProcDirectory.c_str());
+  DIR* directory = opendir(ProcDirectory().c_str());
   if (directory != nullptr) {
     struct dirent* file;
     while ((file = readdir(directory)) != nullptr) {
       // Is this a directory?
       if (file->d_type == DT_DIR) {
         // Is every character of the name a digit?
-        std::string filename(file->d_name);
-        if (std::all_of(filename.begin(), filename.end(), isdigit)) {
-          int pid = stoi(filename);
-          pids.push_back(pid);
+        const char* name = file->d_name;
+        int pid{0};
+        for (; *name >= '0' && *name <= '9'; ++name) {
+          pid = pid * 10 + (*name - '0');
         }
+        if (*name == '\0' && name != file->d_name) pids.push_back(pid);
       }
     }
     closedir(directory);
@@ -89,39 +170,88 @@ std::vector<int> LinuxParser::Pids() {
 }
 
 float LinuxParser::MemoryUtilization() {
-  std::string line;
-  std::string key;
-  long value;
-  long memory_total = 0;
-  long memory_free = 0;
-  std::ifstream stream(kProcDirectory + kMeminfoFilename);
-  if (stream.is_open()) {
-    while (std::getline(stream, line)) {
-      std::replace(line.begin(), line.end(), ':', ' ');
-      std::istringstream line_stream(line);
-      while (line_stream >> key >> value) {
-        if (key == "MemTotal") {
-          memory_total = value;
-        }
-        if (key == "MemFree") {
-          memory_free = value;
-        }
-      }
+  const MemInfo memory = ParseMemInfo();
+  if (memory.total <= 0) return 0.0;
+  return (float)(memory.total - memory.free) / (float)memory.total;
+}
+
+LinuxParser::MemInfo LinuxParser::ParseMemInfo() {
+  MemInfo memory;
+  KeyedFields::Scan(system_paths.meminfo, ':', kMemInfoSchema, memory);
+  return memory;
+}
+
+// Since boot; the scan stops at the matching line
+long LinuxParser::ContextSwitches() {
+  Counter switches;
+  KeyedFields::Scan(system_paths.stat, ' ', kContextSwitchesSchema,
+                    switches);
+  return switches.value;
+}
+
+long LinuxParser::MajorFaults() {
+  Counter faults;
+  KeyedFields::Scan(system_paths.vmstat, ' ', kMajorFaultsSchema, faults);
+  return faults.value;
+}
+
+// Total time tasks waited on all run queues, in ns, from the eighth field
+// of the "cpuN" lines of /proc/schedstat. -1 when the kernel does not
+// provide the file.
+long LinuxParser::RunQueueDelay() {
+  KeyedFields::LineReader reader(system_paths.schedstat);
+  if (!reader.IsOpen()) return -1;
+  long total{0};
+  std::string_view line;
+  while (reader.Next(line)) {
+    if (line.compare(0, 3, "cpu") != 0) continue;
+    const char* end = line.data() + line.size();
+    const char* field = std::find(line.data(), end, ' ');
+    long value{0};
+    int fields{0};
+    for (; fields < 8 && field < end; ++fields) {
+      field = NextLong(field, end, value);
     }
-    return (float)(memory_total - memory_free) / (float)memory_total;
+    if (fields == 8) total += value;
+  }
+  return total;
+}
+
+// "<allocated> <free> <max>"; free has been 0 since Linux 2.6
+LinuxParser::FileHandles LinuxParser::OpenFiles() {
+  FileHandles handles;
+  KeyedFields::LineReader reader(system_paths.file_nr);
+  std::string_view line;
+  if (reader.Next(line)) {
+    const char* end = line.data() + line.size();
+    long free{0};
+    const char* field = NextLong(line.data(), end, handles.allocated);
+    field = NextLong(field, end, free);
+    NextLong(field, end, handles.max);
   }
-  return 0.0;
+  return handles;
+}
+
+float LinuxParser::CpuPressure() {
+  // "some avg10=0.00 avg60=0.00 avg300=0.00 total=0", share of the last 10 s
+  // in which at least one task was stalled waiting for a CPU
+  constexpr std::string_view kSomeAverage{"some avg10="};
+  KeyedFields::LineReader reader(system_paths.pressure_cpu);
+  std::string_view line;
+  float average{0};
+  if (reader.Next(line) && line.compare(0, kSomeAverage.size(),
+                                        kSomeAverage) == 0) {
+    std::from_chars(line.data() + kSomeAverage.size(),
+                    line.data() + line.size(), average);
+  }
+  return average / 100;
 }
 
 long LinuxParser::UpTime() {
-  std::string line;
-  std::ifstream stream(kProcDirectory + kUptimeFilename);
-  if (stream.is_open()) {
-    std::getline(stream, line);
-    std::istringstream line_stream(line);
-    long up_time;
-    line_stream >> up_time;
-    return up_time;
+  KeyedFields::LineReader reader(system_paths.uptime);
+  std::string_view line;
+  if (reader.Next(line)) {
+    return KeyedFields::ParseLong(line.data(), line.data() + line.size());
   }
   return 0;
 }
@@ -135,40 +265,142 @@ long LinuxParser::ActiveJiffies(int pid) {
   // utime, stime, cutime, cstime are in clock ticks
   // clock per second: sysconf(_SC_CLK_TCK) (declared in the header unistd.h)
   std::vector<std::string> process_utilization = ParseProcessStat(pid);
-  long utime = GetValueFromVectorWithDefaultZero(process_utilization, 13);
-  long stime = GetValueFromVectorWithDefaultZero(process_utilization, 14);
-  long cutime = GetValueFromVectorWithDefaultZero(process_utilization, 15);
-  long cstime = GetValueFromVectorWithDefaultZero(process_utilization, 16);
+  long utime = GetValueFromVectorWithDefaultZero(process_utilization, kUTime_);
+  long stime = GetValueFromVectorWithDefaultZero(process_utilization, kSTime_);
+  long cutime =
+      GetValueFromVectorWithDefaultZero(process_utilization, kCUTime_);
+  long cstime =
+      GetValueFromVectorWithDefaultZero(process_utilization, kCSTime_);
   return utime + stime + cutime + cstime;
 }
 
 long LinuxParser::GetValueFromVectorWithDefaultZero(
     const std::vector<std::string>& vec, const int index) {
   try {
-    return std::stol(vec[index]);
-  } catch (const std::out_of_range& oor) {
+    return std::stol(vec.at(index));
+  } catch (const std::logic_error& error) {
     return 0;
   }
 }
 std::vector<std::string> LinuxParser::ParseProcessStat(int pid) {
   std::string line;
-  std::string token;
-  std::vector<std::string> process_utilization;
-  std::ifstream stream(kProcDirectory + std::to_string(pid) + kStatFilename);
+  std::ifstream stream(ProcDirectory() + std::to_string(pid) + kStatFilename);
   if (stream.is_open()) {
     std::getline(stream, line);
-    std::istringstream line_stream(line);
-    while (line_stream >> token) {
-      process_utilization.push_back(token);
-    }
+  }
+  return ParseProcessStat(std::string_view(line));
+}
+
+std::vector<std::string> LinuxParser::ParseProcessStat(std::string_view line) {
+  std::string token;
+  std::vector<std::string> process_utilization;
+  // The command name may contain spaces, so it is cut out between the
+  // first '(' and the last ')' to keep the field indices fixed
+  const std::size_t open = line.find('(');
+  const std::size_t close = line.rfind(')');
+  if (open == std::string::npos || close == std::string::npos || open == 0) {
+    return process_utilization;
+  }
+  process_utilization.emplace_back(line.substr(0, open - 1));
+  process_utilization.emplace_back(line.substr(open, close - open + 1));
+  std::istringstream line_stream(std::string(line.substr(close + 1)));
+  while (line_stream >> token) {
+    process_utilization.push_back(token);
   }
   return process_utilization;
 }
 
+// Allocation free variant for the scan loop. Returns false when the line
+// is not a complete stat line, e.g. because the process has exited.
+bool LinuxParser::ParseProcessStat(std::string_view line, ProcessStat& stat) {
+  const std::size_t open = line.find('(');
+  const std::size_t close = line.rfind(')');
+  if (open == std::string::npos || close == std::string::npos || open == 0 ||
+      close < open) {
+    return false;
+  }
+  stat.comm = line.substr(open + 1, close - open - 1);
+  const char* field = line.data() + close + 1;
+  const char* const end = line.data() + line.size();
+  int index = kComm_;
+  while (field < end && index < kProcessor_) {
+    while (field < end && *field == ' ') ++field;
+    const char* value_end = field;
+    while (value_end < end && *value_end != ' ' && *value_end != '\n') {
+      ++value_end;
+    }
+    if (value_end == field) break;
+    ++index;
+    long* value{nullptr};
+    switch (index) {
+      case kPPid_:
+        value = &stat.parent_pid;
+        break;
+      case kMinFlt_:
+        value = &stat.minor_faults;
+        break;
+      case kMajFlt_:
+        value = &stat.major_faults;
+        break;
+      case kUTime_:
+        value = &stat.utime;
+        break;
+      case kSTime_:
+        value = &stat.stime;
+        break;
+      case kCUTime_:
+        value = &stat.cutime;
+        break;
+      case kCSTime_:
+        value = &stat.cstime;
+        break;
+      case kStartTime_:
+        value = &stat.start_time;
+        break;
+      case kProcessor_:
+        stat.processor = KeyedFields::ParseLong(field, value_end);
+        break;
+    }
+    if (value != nullptr) *value = KeyedFields::ParseLong(field, value_end);
+    field = value_end;
+  }
+  // Kernels older than 2.2.8 end the line before the processor field
+  return index >= kStartTime_;
+}
+
+// First field of /proc/[pid]/statm is the virtual size in pages; returned
+// in kB like VmSize in /proc/[pid]/status
+long LinuxParser::ParseStatmSize(std::string_view statm) {
+  static const long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+  return KeyedFields::ParseLong(statm.data(), statm.data() + statm.size()) *
+         page_kb;
+}
+
+// Second field of /proc/[pid]/statm is the resident set in pages; returned
+// in kB like VmRSS in /proc/[pid]/status
+long LinuxParser::ParseStatmResident(std::string_view statm) {
+  static const long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+  const char* const end = statm.data() + statm.size();
+  long size{0};
+  long resident{0};
+  NextLong(NextLong(statm.data(), end, size), end, resident);
+  return resident * page_kb;
+}
+
+LinuxParser::ProcessIo LinuxParser::ParseProcessIo(std::string_view io) {
+  ProcessIo counters;
+  KeyedFields::Parse(io, ':', kProcessIoSchema, counters);
+  return counters;
+}
+
 long LinuxParser::ActiveJiffies() {
+  return LinuxParser::ActiveJiffies(LinuxParser::CpuUtilization());
+}
+
+long LinuxParser::ActiveJiffies(
+    const std::vector<std::string>& cpu_utilization) {
   // https://stackoverflow.com/questions/23367857/accurate-calculation-of-cpu-usage-given-in-percentage-in-linux
   // expressed in USER_HZ sysconf(_SC_CLK_TCK)
-  std::vector<std::string> cpu_utilization = LinuxParser::CpuUtilization();
   return std::stol(cpu_utilization[kUser_]) +
          std::stol(cpu_utilization[kNice_]) +
          std::stol(cpu_utilization[kSystem_]) +
@@ -178,8 +410,12 @@ long LinuxParser::ActiveJiffies() {
 }
 
 long LinuxParser::IdleJiffies() {
+  return LinuxParser::IdleJiffies(LinuxParser::CpuUtilization());
+}
+
+long LinuxParser::IdleJiffies(
+    const std::vector<std::string>& cpu_utilization) {
   // Expressed in USER_HZ sysconf(_SC_CLK_TCK)
-  std::vector<std::string> cpu_utilization = LinuxParser::CpuUtilization();
   return std::stol(cpu_utilization[kIdle_]) +
          std::stol(cpu_utilization[kIOwait_]);
 }
@@ -192,7 +428,7 @@ std::vector<std::string> LinuxParser::CpuUtilization() {
   std::string line;
   std::string token;
   std::string cpu;
-  std::ifstream file_stream(kProcDirectory + kStatFilename);
+  std::ifstream file_stream(ProcDirectory() + kStatFilename);
   if (file_stream.is_open()) {
     if (std::getline(file_stream, line)) {
       std::istringstream line_stream(line);
@@ -206,43 +442,47 @@ std::vector<std::string> LinuxParser::CpuUtilization() {
   return cpu_utilization;
 }
 
-int LinuxParser::TotalProcesses() {
-  std::string line;
-  std::string key;
-  std::string value;
-  std::ifstream stream(kProcDirectory + kStatFilename);
-  if (stream.is_open()) {
-    while (std::getline(stream, line)) {
-      std::istringstream line_stream(line);
-      while (line_stream >> key >> value) {
-        if (key == "processes") return std::stoi(value);
-      }
-    }
-    return 0;
+// The aggregate "cpu" line of /proc/stat
+LinuxParser::CpuJiffies LinuxParser::SystemJiffies() {
+  KeyedFields::LineReader reader(system_paths.stat);
+  std::string_view line;
+  if (reader.Next(line) && line.compare(0, 4, "cpu ") == 0) {
+    return ParseCpuJiffies(line.data() + 4, line.data() + line.size());
   }
-  return 0;
+  return {};
 }
 
-int LinuxParser::RunningProcesses() {
-  std::string line;
-  std::string key;
-  std::string value;
-  std::ifstream stream(kProcDirectory + kStatFilename);
-  if (stream.is_open()) {
-    while (std::getline(stream, line)) {
-      std::istringstream line_stream(line);
-      while (line_stream >> key >> value) {
-        if (key == "procs_running") return std::stoi(value);
-      }
-    }
-    return 0;
+// The "cpuN" lines of /proc/stat, indexed by N; offline CPUs keep zeros
+void LinuxParser::PerCpuJiffies(std::vector<CpuJiffies>& cpus) {
+  KeyedFields::LineReader reader(system_paths.stat);
+  std::string_view line;
+  while (reader.Next(line)) {
+    if (line.compare(0, 3, "cpu") != 0) break;
+    if (line.size() < 4 || line[3] < '0' || line[3] > '9') continue;
+    long cpu{0};
+    const char* end = line.data() + line.size();
+    const char* fields = NextLong(line.data() + 3, end, cpu);
+    if (static_cast<std::size_t>(cpu) >= cpus.size()) cpus.resize(cpu + 1);
+    cpus[cpu] = ParseCpuJiffies(fields, end);
   }
-  return 0;
+}
+
+int LinuxParser::TotalProcesses() {
+  Counter processes;
+  KeyedFields::Scan(system_paths.stat, ' ', kTotalProcessesSchema, processes);
+  return processes.value;
+}
+
+int LinuxParser::RunningProcesses() {
+  Counter running;
+  KeyedFields::Scan(system_paths.stat, ' ', kRunningProcessesSchema, running);
+  return running.value;
 }
 
 std::string LinuxParser::Command(int pid) {
   std::string line;
-  std::ifstream stream(kProcDirectory + std::to_string(pid) + kCmdlineFilename);
+  std::ifstream stream(ProcDirectory() + std::to_string(pid) +
+                       kCmdlineFilename);
   if (stream.is_open() && std::getline(stream, line)) {
     return line;
   }
@@ -250,47 +490,55 @@ std::string LinuxParser::Command(int pid) {
 }
 
 std::string LinuxParser::Ram(int pid) {
-  std::string line;
-  std::string key;
-  std::string value = "0";
-  std::ifstream stream(kProcDirectory + std::to_string(pid) + kStatusFilename);
-  if (stream.is_open()) {
-    while (std::getline(stream, line)) {
-      std::istringstream line_stream(line);
-      while (line_stream >> key >> value) {
-        if (key == "VmSize:") return std::to_string(std::stoi(value) / 1000);
-      }
-    }
-    return value;
-  }
-  return "";
+  return std::to_string(ParseProcessStatus(pid).vm_size / 1000);
+}
+
+LinuxParser::ProcessStatus LinuxParser::ParseProcessStatus(int pid) {
+  ProcessStatus status;
+  KeyedFields::Scan(ProcDirectory() + std::to_string(pid) + kStatusFilename,
+                    ':', kProcessStatusSchema, status);
+  return status;
+}
+
+LinuxParser::ProcessStatus LinuxParser::ParseProcessStatus(
+    std::string_view status) {
+  ProcessStatus record;
+  KeyedFields::Parse(status, ':', kProcessStatusSchema, record);
+  return record;
 }
 
 std::string LinuxParser::Uid(int pid) {
+  const long uid = ParseProcessStatus(pid).uid;
+  return uid < 0 ? "" : std::to_string(uid);
+}
+
+std::string LinuxParser::User(int pid) {
+  return LinuxParser::UserName(LinuxParser::Uid(pid));
+}
+
+std::string LinuxParser::UserName(const std::string& uid) {
+  std::string ignore;
+  std::string token;
   std::string line;
-  std::string key;
-  std::string value = "";
-  std::ifstream file_stream(kProcDirectory + std::to_string(pid) +
-                            kStatusFilename);
+  std::string username;
+  std::ifstream file_stream(kPasswordPath);
   if (file_stream.is_open()) {
     while (std::getline(file_stream, line)) {
       std::replace(line.begin(), line.end(), ':', ' ');
       std::istringstream line_stream(line);
-      while (line_stream >> key >> value) {
-        if (key == "Uid") {
-          return value;
-        }
+      line_stream >> username >> ignore >> token;
+      if (token == uid) {
+        return username;
       }
     }
-    return value;
+    return username;
   }
   return "";
 }
 
-std::string LinuxParser::User(int pid) {
-  std::string uid = LinuxParser::Uid(pid);
+std::string LinuxParser::Uid(const std::string& user) {
   std::string ignore;
-  std::string token;
+  std::string uid;
   std::string line;
   std::string username;
   std::ifstream file_stream(kPasswordPath);
@@ -298,18 +546,65 @@ std::string LinuxParser::User(int pid) {
     while (std::getline(file_stream, line)) {
       std::replace(line.begin(), line.end(), ':', ' ');
       std::istringstream line_stream(line);
-      line_stream >> username >> ignore >> token;
-      if (token == uid) {
-        return username;
+      line_stream >> username >> ignore >> uid;
+      if (username == user) {
+        return uid;
       }
     }
-    return username;
+  }
+  return "";
+}
+
+// Resident pages per NUMA node, summed over the "N<node>=<pages>" fields
+// of every mapping. The kernel walks the page tables of the whole process
+// to produce the file, so it is only read on demand.
+void LinuxParser::NumaPages(int pid, std::vector<long>& pages) {
+  std::fill(pages.begin(), pages.end(), 0);
+  std::string token;
+  std::ifstream stream(ProcDirectory() + std::to_string(pid) +
+                       kNumaMapsFilename);
+  while (stream >> token) {
+    if (token.size() < 4 || token[0] != 'N' || token[1] < '0' ||
+        token[1] > '9') {
+      continue;
+    }
+    const std::size_t equals = token.find('=');
+    if (equals == std::string::npos) continue;
+    const std::size_t node = std::stoul(token.substr(1, equals - 1));
+    if (node >= pages.size()) pages.resize(node + 1, 0);
+    pages[node] += std::stol(token.substr(equals + 1));
+  }
+}
+
+// "<run ns> <wait ns> <timeslices>", more precise than the jiffies of
+// /proc/[pid]/stat
+LinuxParser::SchedStat LinuxParser::ProcessSchedStat(int pid) {
+  SchedStat sched;
+  std::ifstream stream(ProcDirectory() + std::to_string(pid) +
+                       kSchedstatFilename);
+  long run_ns{0};
+  long wait_ns{0};
+  if (stream >> run_ns >> wait_ns) {
+    sched.run_ns = run_ns;
+    sched.wait_ns = wait_ns;
+  }
+  return sched;
+}
+
+std::string LinuxParser::Cgroup(int pid) {
+  // cgroup v2 has a single "0::/path" line, v1 lists one line per hierarchy
+  // and the first one is as good as any for matching
+  std::string line;
+  std::ifstream stream(ProcDirectory() + std::to_string(pid) + kCgroupFilename);
+  if (stream.is_open() && std::getline(stream, line)) {
+    const std::size_t path = line.find(':', line.find(':') + 1);
+    if (path != std::string::npos) return line.substr(path + 1);
   }
   return "";
 }
 
 long LinuxParser::UpTime(int pid) {
   std::vector<std::string> process_utilization = ParseProcessStat(pid);
-  long start_time = std::stol(process_utilization[21]);
+  long start_time = std::stol(process_utilization.at(kStartTime_));
   return UpTime() - start_time / (long)sysconf(_SC_CLK_TCK);
 }
@@ -20,10 +20,103 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <unistd.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "aggregator.h"
+#include "collector.h"
+#include "linux_parser.h"
 #include "ncurses_display.h"
 #include "system.h"
 
-int main() {
-  System system;
-  NCursesDisplay::Display(system);
-}
\ No newline at end of file
+namespace {
+const std::vector<std::string> kDefaultAlerts{"ram grows 20% over 5m",
+                                              "system cpu > p99 + 3sigma"};
+
+void Usage() {
+  std::cerr << "usage: monitor [--proc-root DIR] [--proc-backend BACKEND] "
+               "[--alert RULE]...\n"
+               "       monitor [--proc-root DIR] [--proc-backend BACKEND] "
+               "[--alert RULE]... "
+               "[--collect ENDPOINT] [--metrics ENDPOINT] [--name HOST] "
+               "[--top N]\n"
+               "       monitor --aggregate ENDPOINT... [--top N]\n"
+               "ENDPOINT is unix:/path/to/socket or host:port\n"
+               "BACKEND is auto, sync or io_uring\n"
+               "RULE is e.g. \"ram grows 20% over 5m\" or "
+               "\"system cpu > p99 + 3sigma\"\n";
+}
+
+std::string HostName() {
+  char name[256] = {};
+  gethostname(name, sizeof(name) - 1);
+  return name;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string collect;
+  std::string metrics;
+  std::vector<std::string> aggregate;
+  std::string name = HostName();
+  std::size_t top{20};
+  std::vector<std::string> alerts;
+  ProcReader::Backend backend{ProcReader::kAuto};
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (arg == "--proc-root" && has_value) {
+      LinuxParser::SetProcDirectory(argv[++i]);
+    } else if (arg == "--proc-backend" && has_value) {
+      const std::string value = argv[++i];
+      if (value == "auto") {
+        backend = ProcReader::kAuto;
+      } else if (value == "sync") {
+        backend = ProcReader::kSync;
+      } else if (value == "io_uring") {
+        backend = ProcReader::kUring;
+      } else {
+        Usage();
+        return 2;
+      }
+    } else if (arg == "--collect" && has_value) {
+      collect = argv[++i];
+    } else if (arg == "--metrics" && has_value) {
+      metrics = argv[++i];
+    } else if (arg == "--name" && has_value) {
+      name = argv[++i];
+    } else if (arg == "--top" && has_value) {
+      top = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--alert" && has_value) {
+      alerts.push_back(argv[++i]);
+    } else if (arg == "--aggregate" && has_value) {
+      while (i + 1 < argc && argv[i + 1][0] != '-') {
+        aggregate.push_back(argv[++i]);
+      }
+    } else {
+      Usage();
+      return 2;
+    }
+  }
+
+  try {
+    if (!aggregate.empty()) {
+      Aggregator aggregator(aggregate, top);
+      aggregator.Run();
+    }
+    if (alerts.empty()) alerts = kDefaultAlerts;
+    System system(backend, alerts);
+    if (!collect.empty() || !metrics.empty()) {
+      Collector collector(system, collect, metrics, name, top);
+      collector.Run();
+    }
+    NCursesDisplay::Display(system);
+  } catch (std::exception& e) {
+    std::cerr << "monitor: " << e.what() << "\n";
+    return 1;
+  }
+}
@@ -0,0 +1,325 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "metrics_server.h"
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "network.h"
+#include "snapshot.h"
+
+namespace {
+const std::size_t kMaxRequest{8192};
+const std::size_t kMaxLabel{128};
+const long kIdleTimeoutNs{5000000000L};
+
+long Now() {
+  timespec now{};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+
+// # TYPE, # UNIT and # HELP lines of one metric family
+void Family(std::string& out, const char* name, const char* type,
+            const char* unit, const char* help) {
+  out += "# TYPE ";
+  out += name;
+  out += ' ';
+  out += type;
+  out += '\n';
+  if (unit != nullptr) {
+    out += "# UNIT ";
+    out += name;
+    out += ' ';
+    out += unit;
+    out += '\n';
+  }
+  out += "# HELP ";
+  out += name;
+  out += ' ';
+  out += help;
+  out += '\n';
+}
+
+// Label values are truncated so a long command line cannot blow up the
+// exposition, and escaped as the format requires. The NUL separators of
+// /proc/[pid]/cmdline and other control bytes become spaces.
+void Label(std::string& out, const char* name, std::string_view value,
+           bool first) {
+  if (!first) out += ',';
+  out += name;
+  out += "=\"";
+  for (const char c : value.substr(0, kMaxLabel)) {
+    if (c == '\\' || c == '"') {
+      out += '\\';
+      out += c;
+    } else if (c == '\n') {
+      out += "\\n";
+    } else if (static_cast<unsigned char>(c) < ' ') {
+      out += ' ';
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+void Value(std::string& out, double value) {
+  char text[32];
+  out.append(text, std::snprintf(text, sizeof(text), " %.6g\n", value));
+}
+
+// Counts are printed in full rather than rounded to six digits
+void Value(std::string& out, long value) {
+  char text[32];
+  out.append(text, std::snprintf(text, sizeof(text), " %ld\n", value));
+}
+
+// One series per top process, labelled with its identity
+template <typename T>
+void ProcessSeries(std::string& out, const char* name,
+                   const ProcessSample& process, T value) {
+  char pid[16];
+  std::snprintf(pid, sizeof(pid), "%d", process.pid);
+  out += name;
+  out += '{';
+  Label(out, "pid", pid, true);
+  Label(out, "user", process.user, false);
+  Label(out, "command", process.command, false);
+  out += '}';
+  Value(out, value);
+}
+
+void Append(std::string& out, std::size_t number) {
+  char text[24];
+  out.append(text, std::snprintf(text, sizeof(text), "%zu", number));
+}
+}  // namespace
+
+MetricsServer::MetricsServer(const std::string& endpoint) {
+  listen_fd_ = Network::Listen(endpoint);
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    close(listen_fd_);
+    throw std::system_error(errno, std::generic_category(), "epoll_create1");
+  }
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = listen_fd_;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event);
+}
+
+MetricsServer::~MetricsServer() {
+  for (auto& connection : connections_) close(connection.first);
+  close(epoll_fd_);
+  close(listen_fd_);
+}
+
+int MetricsServer::EventFd() const { return epoll_fd_; }
+
+// Replaces the exposition, reusing the buffer of the previous one
+void MetricsServer::Update(const Snapshot& snapshot) {
+  std::string& out = body_;
+  out.clear();
+  Family(out, "monitor", "info", nullptr, "Monitored host.");
+  out += "monitor_info{";
+  Label(out, "host", snapshot.host, true);
+  Label(out, "os", snapshot.os, false);
+  Label(out, "kernel", snapshot.kernel, false);
+  out += "} 1\n";
+  Family(out, "monitor_cpu_utilization_ratio", "gauge", "ratio",
+         "Share of CPU time not spent idle.");
+  out += "monitor_cpu_utilization_ratio";
+  Value(out, double{snapshot.cpu});
+  Family(out, "monitor_memory_utilization_ratio", "gauge", "ratio",
+         "Share of memory in use.");
+  out += "monitor_memory_utilization_ratio";
+  Value(out, double{snapshot.memory});
+  Family(out, "monitor_forks", "counter", nullptr,
+         "Processes created since boot.");
+  out += "monitor_forks_total";
+  Value(out, long{snapshot.total_processes});
+  Family(out, "monitor_processes_running", "gauge", nullptr,
+         "Processes in the runnable state.");
+  out += "monitor_processes_running";
+  Value(out, long{snapshot.running_processes});
+  Family(out, "monitor_uptime_seconds", "gauge", "seconds",
+         "Time since boot.");
+  out += "monitor_uptime_seconds";
+  Value(out, snapshot.uptime);
+
+  Family(out, "monitor_process_cpu_utilization_ratio", "gauge", "ratio",
+         "CPU share of the top processes over their lifetime.");
+  for (const ProcessSample& process : snapshot.processes) {
+    ProcessSeries(out, "monitor_process_cpu_utilization_ratio", process,
+                  double{process.cpu});
+  }
+  Family(out, "monitor_process_virtual_memory_megabytes", "gauge",
+         "megabytes", "Virtual memory size of the top processes.");
+  for (const ProcessSample& process : snapshot.processes) {
+    ProcessSeries(out, "monitor_process_virtual_memory_megabytes", process,
+                  process.ram);
+  }
+  Family(out, "monitor_process_uptime_seconds", "gauge", "seconds",
+         "Time since the top processes started.");
+  for (const ProcessSample& process : snapshot.processes) {
+    ProcessSeries(out, "monitor_process_uptime_seconds", process,
+                  process.uptime);
+  }
+  out += "# EOF\n";
+}
+
+void MetricsServer::Poll() {
+  epoll_event events[64];
+  const int ready = epoll_wait(epoll_fd_, events, 64, 0);
+  const long now = Now();
+  for (int i = 0; i < ready; ++i) {
+    const int fd = events[i].data.fd;
+    if (fd == listen_fd_) {
+      Accept();
+      continue;
+    }
+    auto connection = connections_.find(fd);
+    if (connection == connections_.end()) continue;
+    connection->second.active = now;
+    if (events[i].events & (EPOLLERR | EPOLLHUP) ||
+        !Receive(fd, connection->second) || !Flush(fd, connection->second)) {
+      Drop(fd);
+    }
+  }
+  DropIdle(now);
+}
+
+void MetricsServer::Accept() {
+  while (1) {
+    const int fd = accept4(listen_fd_, nullptr, nullptr,
+                           SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) return;
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+    connections_[fd].active = Now();
+  }
+}
+
+// Collects the request head and answers once it is complete. Returns false
+// when the client went away or sent more than a request head.
+bool MetricsServer::Receive(int fd, Connection& connection) {
+  if (!connection.response.empty()) return true;
+  char buffer[4096];
+  while (1) {
+    const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+    if (received == 0) return false;
+    if (received < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    connection.request.append(buffer, received);
+    if (connection.request.find("\r\n\r\n") != std::string::npos) {
+      Respond(connection);
+      return true;
+    }
+    if (connection.request.size() > kMaxRequest) return false;
+  }
+}
+
+void MetricsServer::Respond(Connection& connection) {
+  const std::string_view request = connection.request;
+  const std::string_view line = request.substr(0, request.find("\r\n"));
+  const char* status{"200 OK"};
+  std::string_view body = body_;
+  if (line.substr(0, 4) != "GET ") {
+    status = "405 Method Not Allowed";
+    body = "only GET is supported\n";
+  } else if (line.substr(4, 9) != "/metrics " &&
+             line.substr(4, 9) != "/metrics?") {
+    status = "404 Not Found";
+    body = "metrics are served at /metrics\n";
+  } else if (body_.empty()) {
+    status = "503 Service Unavailable";
+    body = "no snapshot taken yet\n";
+  }
+  std::string& out = connection.response;
+  out += "HTTP/1.1 ";
+  out += status;
+  out += "\r\nContent-Type: ";
+  out += body.data() == body_.data()
+             ? "application/openmetrics-text; version=1.0.0; charset=utf-8"
+             : "text/plain; charset=utf-8";
+  out += "\r\nContent-Length: ";
+  Append(out, body.size());
+  out += "\r\nConnection: close\r\n\r\n";
+  out += body;
+}
+
+// Writes what the socket takes and asks for writability while a remainder
+// is left. Returns false once the response is out or on errors, which
+// closes the connection.
+bool MetricsServer::Flush(int fd, Connection& connection) {
+  if (connection.response.empty()) return true;
+  while (connection.sent < connection.response.size()) {
+    const ssize_t written =
+        send(fd, connection.response.data() + connection.sent,
+             connection.response.size() - connection.sent, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+      epoll_event event{};
+      event.events = EPOLLOUT;
+      event.data.fd = fd;
+      epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event);
+      return true;
+    }
+    connection.sent += written;
+  }
+  return false;
+}
+
+void MetricsServer::Drop(int fd) {
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  close(fd);
+  connections_.erase(fd);
+}
+
+// Poll() runs on every collection tick, which bounds how long an idle
+// connection outlives the timeout
+void MetricsServer::DropIdle(long now) {
+  for (auto connection = connections_.begin();
+       connection != connections_.end();) {
+    if (now - connection->second.active < kIdleTimeoutNs) {
+      ++connection;
+      continue;
+    }
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, connection->first, nullptr);
+    close(connection->first);
+    connection = connections_.erase(connection);
+  }
+}
@@ -23,15 +23,101 @@
 #include "ncurses_display.h"
 
 #include <curses.h>
+#include <unistd.h>
 
-#include <chrono>
+#include <algorithm>
+#include <iterator>
 #include <string>
-#include <thread>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "filter.h"
 #include "format.h"
+#include "scheduler.h"
 #include "system.h"
 
+namespace {
+using NCursesDisplay::View;
+
+// Process table columns in screen order
+enum Column {
+  kPidColumn = 0,
+  kUserColumn,
+  kCpuColumn,
+  kRamColumn,
+  kTimeColumn,
+  kMinorFaultsColumn,
+  kMajorFaultsColumn,
+  kVoluntaryColumn,
+  kInvoluntaryColumn,
+  kOnCpuColumn,
+  kRunQueueColumn,
+  kFdsColumn,
+  kFdKindsColumn,
+  kCommandColumn,
+  kNumColumns
+};
+
+// drop is the order in which columns give way to COMMAND on narrow
+// windows, 0 for columns that are always shown; sort is -1 for columns
+// that cannot be sorted by
+struct ColumnSpec {
+  const char* title;
+  int width;
+  int drop;
+  int sort;
+};
+
+constexpr ColumnSpec kColumns[kNumColumns] = {
+    {"PID", 7, 0, View::kPid},
+    {"USER", 7, 0, View::kUser},
+    {"CPU[%]", 10, 0, View::kCpu},
+    {"RAM[MB]", 9, 0, View::kRam},
+    {"TIME+", 11, 0, View::kTime},
+    {"MINFLT", 8, 3, View::kMinorFaults},
+    {"MAJFLT", 8, 6, View::kMajorFaults},
+    {"CSW", 8, 5, View::kVoluntarySwitches},
+    {"ICSW", 8, 4, View::kInvoluntarySwitches},
+    {"ONCPU", 7, 8, -1},
+    {"RQWAIT", 8, 7, -1},
+    {"FDS", 6, 2, View::kFdLimit},
+    {"SOCK/PIPE/FILE", 16, 1, -1},
+    {"COMMAND", 0, 0, View::kCommand}};
+
+const int kFirstColumn{2};
+const int kMinCommandWidth{20};
+
+// Start of each shown column, -1 for hidden ones. Optional columns are
+// dropped in their drop order until COMMAND keeps kMinCommandWidth
+// characters, except the one the table is sorted by.
+void LayoutColumns(int width, View::Sort sort, int (&start)[kNumColumns]) {
+  bool shown[kNumColumns];
+  int used{kFirstColumn};
+  for (int i = 0; i < kNumColumns; ++i) {
+    shown[i] = true;
+    used += kColumns[i].width;
+  }
+  while (width - used < kMinCommandWidth) {
+    int drop{-1};
+    for (int i = 0; i < kNumColumns; ++i) {
+      if (shown[i] && kColumns[i].drop > 0 && kColumns[i].sort != sort &&
+          (drop < 0 || kColumns[i].drop < kColumns[drop].drop)) {
+        drop = i;
+      }
+    }
+    if (drop < 0) break;
+    shown[drop] = false;
+    used -= kColumns[drop].width;
+  }
+  int column{kFirstColumn};
+  for (int i = 0; i < kNumColumns; ++i) {
+    start[i] = shown[i] ? column : -1;
+    if (shown[i]) column += kColumns[i].width;
+  }
+}
+}  // namespace
+
 // 50 bars uniformly displayed from 0 - 100 %
 // 2% is one bar(|)
 std::string NCursesDisplay::ProgressBar(float percent) {
@@ -51,84 +137,564 @@ std::string NCursesDisplay::ProgressBar(float percent) {
 
 void NCursesDisplay::DisplaySystem(System& system, WINDOW* window) {
   int row{0};
-  mvwprintw(window, ++row, 2, ("OS: " + system.OperatingSystem()).c_str());
-  mvwprintw(window, ++row, 2, ("Kernel: " + system.Kernel()).c_str());
+  mvwprintw(window, ++row, 2, "OS: %s", system.OperatingSystem().c_str());
+  mvwprintw(window, ++row, 2, "Kernel: %s", system.Kernel().c_str());
   mvwprintw(window, ++row, 2, "CPU: ");
   wattron(window, COLOR_PAIR(1));
   mvwprintw(window, row, 10, "");
-  wprintw(window, ProgressBar(system.Cpu().Utilization()).c_str());
+  wprintw(window, "%s", ProgressBar(system.Cpu().Utilization()).c_str());
   wattroff(window, COLOR_PAIR(1));
   mvwprintw(window, ++row, 2, "Memory: ");
   wattron(window, COLOR_PAIR(1));
   mvwprintw(window, row, 10, "");
-  wprintw(window, ProgressBar(system.MemoryUtilization()).c_str());
+  wprintw(window, "%s", ProgressBar(system.MemoryUtilization()).c_str());
   wattroff(window, COLOR_PAIR(1));
-  mvwprintw(
-      window, ++row, 2,
-      ("Total Processes: " + std::to_string(system.TotalProcesses())).c_str());
-  mvwprintw(window, ++row, 2,
-            ("Running Processes: " + std::to_string(system.RunningProcesses()))
-                .c_str());
+  mvwprintw(window, ++row, 2, "CPU PSI:");
+  wattron(window, COLOR_PAIR(1));
+  wmove(window, row, 10);
+  wprintw(window, "%s", ProgressBar(system.CpuPressure()).c_str());
+  wattroff(window, COLOR_PAIR(1));
+  const LinuxParser::FileHandles& files = system.OpenFiles();
+  mvwprintw(window, ++row, 2, "Total Processes: %d, Open Files: %ld of %ld",
+            system.TotalProcesses(), files.allocated, files.max);
+  mvwprintw(window, ++row, 2, "Running Processes: %d",
+            system.RunningProcesses());
   mvwprintw(window, ++row, 2,
-            ("Up Time: " + Format::ElapsedTime(system.UpTime())).c_str());
+            "Context Switches: %.0f/s, Major Faults: %.0f/s, Run Queue Delay: ",
+            system.ContextSwitchRate(), system.MajorFaultRate());
+  if (system.RunQueueDelay() < 0) {
+    wprintw(window, "n/a");
+  } else {
+    wprintw(window, "%.1f ms/s", system.RunQueueDelay() / 1e6);
+  }
+  mvwprintw(window, ++row, 2, "Up Time: %s",
+            Format::ElapsedTime(system.UpTime()).c_str());
+  // Cost of the last scan of each backend that ran, for comparison
+  mvwprintw(window, ++row, 2, "Process Scan:");
+  for (ProcReader::Backend backend : {ProcReader::kUring, ProcReader::kSync}) {
+    const ProcReader::Stats& scan = system.ProcScan().LastScan(backend);
+    if (*scan.backend == '\0') continue;
+    wprintw(window, " %s %ld calls/%.1f ms,", scan.backend, scan.syscalls,
+            scan.nanoseconds / 1e6);
+  }
+  wprintw(window, " PIDs +%d -%d", system.Pids().Started(),
+          system.Pids().Exited());
+  // The first firing alert is spelled out, the process table marks the rest
+  const std::vector<Alerts::Alert>& alerts = system.Alerting().Firing();
+  mvwprintw(window, ++row, 2, "Alerts: ");
+  if (alerts.empty()) {
+    wprintw(window, "none");
+  } else {
+    const Alerts::Alert& alert = alerts.front();
+    wattron(window, COLOR_PAIR(3) | A_BOLD);
+    wprintw(window, "%zu firing, %s (%d): %s, %.1f > %.1f", alerts.size(),
+            alert.subject.c_str(), alert.pid, alert.rule->c_str(),
+            alert.value, alert.limit);
+    wattroff(window, COLOR_PAIR(3) | A_BOLD);
+  }
   wrefresh(window);
 }
 
-void NCursesDisplay::DisplayProcesses(std::vector<Process>& processes,
-                                      WINDOW* window, int n) {
+// Only the visible slice is formatted, so lazily read fields such as user
+// and command are resolved for at most one screen of rows
+void NCursesDisplay::DisplayProcesses(
+    const std::vector<const Process*>& processes, const View& view,
+    const Alerts& alerts, WINDOW* window, int n) {
+  int row{0};
+  int start[kNumColumns];
+  LayoutColumns(window->_maxx, view.sort, start);
+  wattron(window, COLOR_PAIR(2));
+  ++row;
+  for (int i = 0; i < kNumColumns; ++i) {
+    if (start[i] < 0) continue;
+    if (view.sort == kColumns[i].sort) wattron(window, A_REVERSE);
+    mvwprintw(window, row, start[i], "%s", kColumns[i].title);
+    wattroff(window, A_REVERSE);
+  }
+  wattroff(window, COLOR_PAIR(2));
+  // Prints into a column unless it was dropped for lack of width
+  auto cell = [&](Column column, const char* format, auto... values) {
+    if (start[column] >= 0) {
+      mvwprintw(window, row, start[column], format, values...);
+    }
+  };
+  int const end = std::min<int>(processes.size(), view.offset + n);
+  for (int i = view.offset; i < end; ++i) {
+    const Process& process = *processes[i];
+    const bool alerting = alerts.Firing(process.Pid());
+    if (alerting) wattron(window, COLOR_PAIR(3) | A_BOLD);
+    ++row;
+    cell(kPidColumn, "%d", process.Pid());
+    const std::string_view user = process.User();
+    cell(kUserColumn, "%.*s", int(user.size()), user.data());
+    float cpu = process.CpuUtilization() * 100;
+    cell(kCpuColumn, "%s", std::to_string(cpu).substr(0, 4).c_str());
+    cell(kRamColumn, "%ld", process.Ram());
+    cell(kTimeColumn, "%s", Format::ElapsedTime(process.UpTime()).c_str());
+    cell(kMinorFaultsColumn, "%.0f", process.MinorFaultRate());
+    cell(kMajorFaultsColumn, "%.0f", process.MajorFaultRate());
+    cell(kVoluntaryColumn, "%.0f", process.VoluntarySwitchRate());
+    cell(kInvoluntaryColumn, "%.0f", process.InvoluntarySwitchRate());
+    // Shares stay unknown until a row was on screen for two samples
+    if (process.OnCpuShare() < 0) {
+      cell(kOnCpuColumn, "-");
+      cell(kRunQueueColumn, "-");
+    } else {
+      cell(kOnCpuColumn, "%.1f", process.OnCpuShare() * 100);
+      cell(kRunQueueColumn, "%.1f", process.RunQueueShare() * 100);
+    }
+    const FdScanner::Counts& fds = process.Fds();
+    if (fds.total < 0) {
+      cell(kFdsColumn, "-");
+    } else {
+      cell(kFdsColumn, "%d", fds.total);
+      cell(kFdKindsColumn, "%d/%d/%d", fds.sockets, fds.pipes, fds.files);
+    }
+    const std::string_view command = process.Command().substr(
+        0, std::max(0, window->_maxx - start[kCommandColumn]));
+    cell(kCommandColumn, "%.*s", int(command.size()), command.data());
+    if (alerting) wattroff(window, COLOR_PAIR(3) | A_BOLD);
+  }
+}
+
+// Search box and scroll position drawn into the bottom border of the
+// process window
+void NCursesDisplay::DisplayStatus(const Search& search, int offset, int rows,
+                                   int total, WINDOW* window) {
+  const int first = total > 0 ? offset + 1 : 0;
+  const int last = std::min(total, offset + rows);
+  std::string status = " " + std::to_string(first) + "-" +
+                       std::to_string(last) + " of " + std::to_string(total) +
+                       " ";
+  if (search.editing || !search.query.empty()) {
+    status += " /" + search.query + (search.valid ? "" : "  [invalid filter]") +
+              " ";
+  }
+  mvwprintw(window, getmaxy(window) - 1, 2, "%s", status.c_str());
+}
+
+// Refills matches, keeping its capacity between refreshes
+void NCursesDisplay::FilterProcesses(const std::vector<Process>& processes,
+                                     const Filter& filter,
+                                     std::vector<const Process*>& matches) {
+  matches.clear();
+  for (const Process& process : processes) {
+    if (filter.Empty() || filter.Matches(process)) matches.push_back(&process);
+  }
+}
+
+// Only fields known for every process are sort keys, so a resort never
+// resolves the lazy user and command of rows off screen: the user column
+// sorts by uid and the command column by the process name from stat
+void NCursesDisplay::SortProcesses(std::vector<const Process*>& processes,
+                                   const View& view) {
+  auto order = [&view](auto key) {
+    return [&view, key](const Process* a, const Process* b) {
+      return view.ascending ? key(*a) < key(*b) : key(*b) < key(*a);
+    };
+  };
+  switch (view.sort) {
+    case View::kPid:
+      std::stable_sort(processes.begin(), processes.end(),
+                       order([](const Process& p) { return p.Pid(); }));
+      break;
+    case View::kUser:
+      std::stable_sort(processes.begin(), processes.end(),
+                       order([](const Process& p) { return p.Uid(); }));
+      break;
+    case View::kCpu:
+      std::stable_sort(
+          processes.begin(), processes.end(),
+          order([](const Process& p) { return p.CpuUtilization(); }));
+      break;
+    case View::kRam:
+      std::stable_sort(processes.begin(), processes.end(),
+                       order([](const Process& p) { return p.Ram(); }));
+      break;
+    case View::kTime:
+      std::stable_sort(processes.begin(), processes.end(),
+                       order([](const Process& p) { return p.UpTime(); }));
+      break;
+    case View::kMinorFaults:
+      std::stable_sort(
+          processes.begin(), processes.end(),
+          order([](const Process& p) { return p.MinorFaultRate(); }));
+      break;
+    case View::kMajorFaults:
+      std::stable_sort(
+          processes.begin(), processes.end(),
+          order([](const Process& p) { return p.MajorFaultRate(); }));
+      break;
+    case View::kVoluntarySwitches:
+      std::stable_sort(
+          processes.begin(), processes.end(),
+          order([](const Process& p) { return p.VoluntarySwitchRate(); }));
+      break;
+    case View::kInvoluntarySwitches:
+      std::stable_sort(
+          processes.begin(), processes.end(),
+          order([](const Process& p) { return p.InvoluntarySwitchRate(); }));
+      break;
+    case View::kFdLimit:
+      std::stable_sort(
+          processes.begin(), processes.end(),
+          order([](const Process& p) { return p.FdLimitShare(); }));
+      break;
+    case View::kCommand:
+      std::stable_sort(processes.begin(), processes.end(),
+                       order([](const Process& p) { return p.Name(); }));
+      break;
+  }
+}
+
+// Returns true when the table has to be re-sorted
+bool NCursesDisplay::HandleViewKey(int key, View& view, int rows, int total) {
+  const int last = std::max(0, total - rows);
+  const View::Sort sorts[] = {View::kPid,
+                              View::kUser,
+                              View::kCpu,
+                              View::kRam,
+                              View::kTime,
+                              View::kMinorFaults,
+                              View::kMajorFaults,
+                              View::kVoluntarySwitches,
+                              View::kInvoluntarySwitches,
+                              View::kFdLimit,
+                              View::kCommand};
+  const char sort_keys[] = {'p', 'u', 'c', 'm', 't', 'f',
+                            'F', 'v', 'i', 'o', 'n'};
+  for (std::size_t i = 0; i < std::size(sorts); ++i) {
+    if (key != sort_keys[i]) continue;
+    // Selecting the active column again flips its order
+    view.ascending = view.sort == sorts[i] ? !view.ascending
+                                           : sorts[i] == View::kPid ||
+                                                 sorts[i] == View::kUser ||
+                                                 sorts[i] == View::kCommand;
+    view.sort = sorts[i];
+    view.offset = 0;
+    return true;
+  }
+  switch (key) {
+    case KEY_UP:
+    case 'k':
+      view.offset -= 1;
+      break;
+    case KEY_DOWN:
+    case 'j':
+      view.offset += 1;
+      break;
+    case KEY_PPAGE:
+      view.offset -= rows;
+      break;
+    case KEY_NPAGE:
+    case ' ':
+      view.offset += rows;
+      break;
+    case KEY_HOME:
+    case 'g':
+      view.offset = 0;
+      break;
+    case KEY_END:
+    case 'G':
+      view.offset = last;
+      break;
+  }
+  view.offset = std::max(0, std::min(view.offset, last));
+  return false;
+}
+
+// Returns true when the filter changed and the table has to be redrawn
+bool NCursesDisplay::HandleSearchKey(int key, Search& search) {
+  if (!search.editing) {
+    if (key != '/') return false;
+    search.editing = true;
+    return true;
+  }
+  if (key == '\n' || key == KEY_ENTER) {
+    search.editing = false;
+    return true;
+  }
+  if (key == 27) {  // Escape
+    search = Search{};
+    return true;
+  }
+  if (key == KEY_BACKSPACE || key == 127 || key == '\b') {
+    if (search.query.empty()) return false;
+    search.query.pop_back();
+  } else if (key >= ' ' && key <= '~') {
+    search.query += static_cast<char>(key);
+  } else {
+    return false;
+  }
+  // Keep the last good filter while a half typed term does not parse
+  try {
+    search.filter = Filter(search.query);
+    search.valid = true;
+  } catch (std::exception& e) {
+    search.valid = false;
+  }
+  return true;
+}
+
+// Windows always span the whole terminal and are rebuilt when it is resized
+// or an optional panel is toggled
+void NCursesDisplay::Layout(Windows& windows, bool show_numa,
+                            bool show_exits) {
+  for (WINDOW* window : {windows.system, windows.network, windows.process,
+                         windows.numa, windows.exit}) {
+    if (window != nullptr) delwin(window);
+  }
+  windows = Windows{};
+  int const system_rows{13};
+  int const network_rows{8};
+  int const numa_rows{show_numa ? 12 : 0};
+  int const exit_rows{show_exits ? 9 : 0};
+  int const x_max{getmaxx(stdscr)};
+  int const y_max{getmaxy(stdscr)};
+  int const process_rows{std::max(
+      4, y_max - system_rows - network_rows - numa_rows - exit_rows)};
+  int y{0};
+  windows.system = newwin(system_rows, x_max - 1, y, 0);
+  y += system_rows;
+  windows.network = newwin(network_rows, x_max - 1, y, 0);
+  y += network_rows;
+  windows.process = newwin(process_rows, x_max - 1, y, 0);
+  y += process_rows;
+  if (show_numa) {
+    windows.numa = newwin(numa_rows, x_max - 1, y, 0);
+    y += numa_rows;
+  }
+  if (show_exits) windows.exit = newwin(exit_rows, x_max - 1, y, 0);
+  clear();
+  refresh();
+}
+
+// Only interfaces that are up and moved traffic in the last interval are
+// listed, busiest first, so hundreds of idle veth devices take no rows
+void NCursesDisplay::DisplayNetwork(
+    const NetworkTraffic& network,
+    std::vector<const NetworkTraffic::Interface*>& active, WINDOW* window) {
+  int row{0};
+  int const name_column{2};
+  int const rx_column{19};
+  int const rx_packets_column{28};
+  int const tx_column{37};
+  int const tx_packets_column{46};
+  int const errors_column{55};
+  int const drops_column{64};
+  mvwprintw(window, ++row, 2,
+            "TCP retransmits: %.1f/s, sockets: %ld, TCP: %ld in use, "
+            "%ld time wait, UDP: %ld in use",
+            network.RetransmitRate(), network.SocketsUsed(),
+            network.TcpInUse(), network.TcpTimeWait(), network.UdpInUse());
+  wattron(window, COLOR_PAIR(2));
+  mvwprintw(window, ++row, name_column, "INTERFACE");
+  mvwprintw(window, row, rx_column, "RX B/s");
+  mvwprintw(window, row, rx_packets_column, "RX pk/s");
+  mvwprintw(window, row, tx_column, "TX B/s");
+  mvwprintw(window, row, tx_packets_column, "TX pk/s");
+  mvwprintw(window, row, errors_column, "ERR/s");
+  mvwprintw(window, row, drops_column, "DROP/s");
+  wattroff(window, COLOR_PAIR(2));
+  network.Active(active);
+  for (const NetworkTraffic::Interface* interface : active) {
+    if (row >= getmaxy(window) - 2) break;
+    mvwprintw(window, ++row, name_column, "%s", interface->name);
+    mvwprintw(window, row, rx_column, "%s",
+              Format::Rate(interface->rx_bytes_rate).c_str());
+    mvwprintw(window, row, rx_packets_column, "%s",
+              Format::Rate(interface->rx_packets_rate).c_str());
+    mvwprintw(window, row, tx_column, "%s",
+              Format::Rate(interface->tx_bytes_rate).c_str());
+    mvwprintw(window, row, tx_packets_column, "%s",
+              Format::Rate(interface->tx_packets_rate).c_str());
+    mvwprintw(window, row, errors_column, "%.1f", interface->errors_rate);
+    mvwprintw(window, row, drops_column, "%.1f", interface->drops_rate);
+  }
+}
+
+// numa_maps makes the kernel walk the page tables of the whole process, so
+// it is only read for the top processes by CPU while this panel is shown.
+// A process is flagged when most of its resident pages sit on another node
+// than the CPU it last ran on.
+void NCursesDisplay::DisplayNuma(const NumaTopology& numa,
+                                 const std::vector<Process>& processes,
+                                 std::vector<long>& pages, WINDOW* window) {
   int row{0};
   int const pid_column{2};
-  int const user_column{9};
-  int const cpu_column{16};
-  int const ram_column{26};
-  int const time_column{35};
-  int const command_column{46};
+  int const cpu_column{9};
+  int const node_column{14};
+  int const pages_column{20};
+  mvwprintw(window, ++row, 2, "CPU by node:");
+  for (int node = 0; node < numa.Nodes(); ++node) {
+    wprintw(window, "  N%d %.1f%%", node, numa.Utilization(node) * 100);
+  }
   wattron(window, COLOR_PAIR(2));
   mvwprintw(window, ++row, pid_column, "PID");
-  mvwprintw(window, row, user_column, "USER");
-  mvwprintw(window, row, cpu_column, "CPU[%%]");
-  mvwprintw(window, row, ram_column, "RAM[MB]");
-  mvwprintw(window, row, time_column, "TIME+");
+  mvwprintw(window, row, cpu_column, "CPU");
+  mvwprintw(window, row, node_column, "NODE");
+  mvwprintw(window, row, pages_column, "RESIDENT PAGES BY NODE");
+  wattroff(window, COLOR_PAIR(2));
+  for (const Process& process : processes) {
+    if (row >= getmaxy(window) - 2) break;
+    const int node = numa.NodeOf(process.LastCpu());
+    pages.assign(numa.Nodes(), 0);
+    LinuxParser::NumaPages(process.Pid(), pages);
+    const auto most = std::max_element(pages.begin(), pages.end());
+    const bool remote = *most > 0 && most - pages.begin() != node;
+    if (remote) wattron(window, COLOR_PAIR(3) | A_BOLD);
+    mvwprintw(window, ++row, pid_column, "%d", process.Pid());
+    mvwprintw(window, row, cpu_column, "%d", process.LastCpu());
+    mvwprintw(window, row, node_column, "%d", node);
+    wmove(window, row, pages_column);
+    for (std::size_t i = 0; i < pages.size(); ++i) {
+      wprintw(window, "N%zu=%ld ", i, pages[i]);
+    }
+    if (remote) wprintw(window, " remote memory");
+    if (remote) wattroff(window, COLOR_PAIR(3) | A_BOLD);
+  }
+}
+
+void NCursesDisplay::DisplayExits(const ExitTracker& exits, WINDOW* window) {
+  int row{0};
+  int const count_column{2};
+  int const cpu_column{9};
+  int const command_column{19};
+  const long hertz = sysconf(_SC_CLK_TCK);
+  int total{0};
+  long jiffies{0};
+  for (const ExitTracker::Summary& exit : exits.Exits()) {
+    total += exit.count;
+    jiffies += exit.jiffies;
+  }
+  mvwprintw(window, ++row, 2,
+            "Exited since last tick: %d processes, %.2f s CPU (%s)", total,
+            static_cast<float>(jiffies) / hertz,
+            exits.Events() ? "process events" : "scan differences");
+  wattron(window, COLOR_PAIR(2));
+  mvwprintw(window, ++row, count_column, "COUNT");
+  mvwprintw(window, row, cpu_column, "CPU[s]");
   mvwprintw(window, row, command_column, "COMMAND");
   wattroff(window, COLOR_PAIR(2));
-  int const num_processes = int(processes.size()) > n ? n : processes.size();
-  for (int i = 0; i < num_processes; ++i) {
-    mvwprintw(window, ++row, pid_column,
-              std::to_string(processes[i].Pid()).c_str());
-    mvwprintw(window, row, user_column, processes[i].User().c_str());
-    float cpu = processes[i].CpuUtilization() * 100;
-    mvwprintw(window, row, cpu_column,
-              std::to_string(cpu).substr(0, 4).c_str());
-    mvwprintw(window, row, ram_column, processes[i].Ram().c_str());
-    mvwprintw(window, row, time_column,
-              Format::ElapsedTime(processes[i].UpTime()).c_str());
-    mvwprintw(window, row, command_column,
-              processes[i].Command().substr(0, window->_maxx - 46).c_str());
+  for (const ExitTracker::Summary& exit : exits.Exits()) {
+    if (row >= getmaxy(window) - 2) break;
+    mvwprintw(window, ++row, count_column, "%d", exit.count);
+    mvwprintw(window, row, cpu_column, "%.2f",
+              static_cast<float>(exit.jiffies) / hertz);
+    mvwprintw(window, row, command_column, "%s",
+              exit.command.substr(0, getmaxx(window) - 21).c_str());
   }
 }
 
-void NCursesDisplay::Display(System& system, int n) {
+void NCursesDisplay::Display(System& system) {
   initscr();      // start ncurses
   noecho();       // do not print input values
   cbreak();       // terminate ncurses on ctrl + c
   start_color();  // enable color
+  curs_set(0);
+  keypad(stdscr, TRUE);
+  nodelay(stdscr, TRUE);
+  set_escdelay(25);
 
-  int x_max{getmaxx(stdscr)};
-  WINDOW* system_window = newwin(9, x_max - 1, 0, 0);
-  WINDOW* process_window =
-      newwin(3 + n, x_max - 1, system_window->_maxy + 1, 0);
+  Windows windows;
+  bool show_numa{false};
+  Layout(windows, show_numa, false);
 
+  Scheduler scheduler;
+  scheduler.WakeOn(STDIN_FILENO);
+  Search search;
+  View view;
+  std::vector<const Process*> matches;
+  // PIDs of the rows on screen, counted first by the next CountFds
+  std::vector<int> shown;
+  std::vector<const NetworkTraffic::Interface*> interfaces;
+  std::vector<long> pages;
   while (1) {
+    const unsigned due = scheduler.Wait();
+    scheduler.BeginCollection();
+    system.Refresh(due);
+    scheduler.EndCollection();
+
+    // Rows visible below the border and the column header
+    int rows = getmaxy(windows.process) - 3;
+    bool resized{false};
+    bool resort{false};
+    bool scrolled{false};
+    for (int key = getch(); key != ERR; key = getch()) {
+      if (key == KEY_RESIZE ||
+          ((key == 'x' || key == 'N') && !search.editing)) {
+        ExitTracker& exits = system.Exits();
+        if (key == 'N') show_numa = !show_numa;
+        if (key == 'x') {
+          scheduler.Forget(exits.EventFd());
+          exits.Enable(!exits.Enabled());
+          // Events are drained on every wake up, not just on ticks
+          if (exits.Events()) scheduler.WakeOn(exits.EventFd());
+        }
+        Layout(windows, show_numa, exits.Enabled());
+        rows = getmaxy(windows.process) - 3;
+        resized = true;
+      } else if (search.editing || key == '/') {
+        resort |= HandleSearchKey(key, search);
+      } else {
+        const int offset = view.offset;
+        resort |= HandleViewKey(key, view, rows, matches.size());
+        scrolled |= view.offset != offset;
+      }
+    }
+
     init_pair(1, COLOR_BLUE, COLOR_BLACK);
     init_pair(2, COLOR_GREEN, COLOR_BLACK);
-    box(system_window, 0, 0);
-    box(process_window, 0, 0);
-    DisplaySystem(system, system_window);
-    DisplayProcesses(system.Processes(), process_window, n);
-    wrefresh(system_window);
-    wrefresh(process_window);
-    refresh();
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    init_pair(3, COLOR_RED, COLOR_BLACK);
+    if (due || resized) {
+      werase(windows.system);
+      box(windows.system, 0, 0);
+      DisplaySystem(system, windows.system);
+      wrefresh(windows.system);
+    }
+    if (resized || Scheduler::Due(due, Scheduler::kNetwork)) {
+      werase(windows.network);
+      box(windows.network, 0, 0);
+      DisplayNetwork(system.Network(), interfaces, windows.network);
+      wrefresh(windows.network);
+    }
+    if (windows.numa != nullptr &&
+        (resized || Scheduler::Due(due, Scheduler::kProcesses))) {
+      werase(windows.numa);
+      box(windows.numa, 0, 0);
+      DisplayNuma(system.Numa(), system.Processes(), pages, windows.numa);
+      wrefresh(windows.numa);
+    }
+    if (windows.exit != nullptr &&
+        (resized || Scheduler::Due(due, Scheduler::kProcesses))) {
+      werase(windows.exit);
+      box(windows.exit, 0, 0);
+      DisplayExits(system.Exits(), windows.exit);
+      wrefresh(windows.exit);
+    }
+    // Filtering and sorting only happen when the data, the filter or the
+    // sort order changed; scrolling just draws a different slice
+    if (resort || Scheduler::Due(due, Scheduler::kProcesses) ||
+        Scheduler::Due(due, Scheduler::kMemory)) {
+      system.CountFds(shown);
+      FilterProcesses(system.Processes(), search.filter, matches);
+      SortProcesses(matches, view);
+      view.offset = std::max(
+          0, std::min<int>(view.offset, int(matches.size()) - rows));
+    } else if (!scrolled && !resized) {
+      continue;
+    }
+    system.SampleSchedStats(matches, view.offset, rows);
+    werase(windows.process);
+    box(windows.process, 0, 0);
+    DisplayProcesses(matches, view, system.Alerting(), windows.process, rows);
+    shown.clear();
+    for (int i = view.offset;
+         i < std::min<int>(matches.size(), view.offset + rows); ++i) {
+      shown.push_back(matches[i]->Pid());
+    }
+    DisplayStatus(search, view.offset, rows, matches.size(), windows.process);
+    wrefresh(windows.process);
   }
   endwin();
 }
@@ -0,0 +1,147 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "network.h"
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace {
+const std::string kUnixPrefix{"unix:"};
+
+bool IsUnix(const std::string& endpoint) {
+  return endpoint.rfind(kUnixPrefix, 0) == 0;
+}
+
+sockaddr_un UnixAddress(const std::string& endpoint) {
+  const std::string path = endpoint.substr(kUnixPrefix.size());
+  sockaddr_un address{};
+  if (path.size() >= sizeof(address.sun_path)) {
+    throw std::invalid_argument("socket path too long: " + path);
+  }
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  return address;
+}
+
+addrinfo* TcpAddresses(const std::string& endpoint, bool passive) {
+  const std::size_t colon = endpoint.rfind(':');
+  if (colon == std::string::npos) {
+    throw std::invalid_argument("expected host:port, got " + endpoint);
+  }
+  const std::string host = endpoint.substr(0, colon);
+  const std::string port = endpoint.substr(colon + 1);
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = passive ? AI_PASSIVE : 0;
+  addrinfo* addresses{nullptr};
+  const int error = getaddrinfo(host.empty() ? nullptr : host.c_str(),
+                                port.c_str(), &hints, &addresses);
+  if (error != 0) {
+    throw std::runtime_error(endpoint + ": " + gai_strerror(error));
+  }
+  return addresses;
+}
+
+void Fail(const std::string& what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+}  // namespace
+
+// Throws std::system_error when the endpoint cannot be bound
+int Network::Listen(const std::string& endpoint) {
+  if (IsUnix(endpoint)) {
+    const sockaddr_un address = UnixAddress(endpoint);
+    const int fd =
+        socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) Fail("socket");
+    unlink(address.sun_path);
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&address),
+             sizeof(address)) < 0 ||
+        listen(fd, SOMAXCONN) < 0) {
+      close(fd);
+      Fail(endpoint);
+    }
+    return fd;
+  }
+  addrinfo* addresses = TcpAddresses(endpoint, true);
+  int fd{-1};
+  for (addrinfo* a = addresses; a != nullptr; a = a->ai_next) {
+    fd = socket(a->ai_family, a->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                a->ai_protocol);
+    if (fd < 0) continue;
+    const int reuse{1};
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(fd, a->ai_addr, a->ai_addrlen) == 0 &&
+        listen(fd, SOMAXCONN) == 0) {
+      break;
+    }
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(addresses);
+  if (fd < 0) Fail(endpoint);
+  return fd;
+}
+
+// The connection may still be in progress when this returns; the caller
+// learns the outcome from the first readiness event on the socket.
+// Returns -1 when the endpoint refuses the connection right away.
+int Network::Connect(const std::string& endpoint) {
+  if (IsUnix(endpoint)) {
+    const sockaddr_un address = UnixAddress(endpoint);
+    const int fd =
+        socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) Fail("socket");
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address),
+                sizeof(address)) < 0 &&
+        errno != EINPROGRESS && errno != EAGAIN) {
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }
+  addrinfo* addresses = TcpAddresses(endpoint, false);
+  int fd{-1};
+  for (addrinfo* a = addresses; a != nullptr; a = a->ai_next) {
+    fd = socket(a->ai_family, a->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                a->ai_protocol);
+    if (fd < 0) continue;
+    if (connect(fd, a->ai_addr, a->ai_addrlen) == 0 || errno == EINPROGRESS) {
+      break;
+    }
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(addresses);
+  return fd;
+}
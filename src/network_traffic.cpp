@@ -0,0 +1,293 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "network_traffic.h"
+
+#include <fcntl.h>
+#include <linux_parser.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+const std::string kNetDevFilename{"net/dev"};
+const std::string kNetSnmpFilename{"net/snmp"};
+const std::string kNetSockstatFilename{"net/sockstat"};
+
+long Now() {
+  timespec now{};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+
+// Next unsigned number at or after p, advancing p past it
+long Next(const char*& p, const char* end) {
+  while (p < end && (*p < '0' || *p > '9')) ++p;
+  long value{0};
+  while (p < end && *p >= '0' && *p <= '9') value = value * 10 + (*p++ - '0');
+  return value;
+}
+
+const char* LineEnd(const char* p, const char* end) {
+  const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+  return newline != nullptr ? newline : end;
+}
+
+bool StartsWith(const char* p, const char* end, const char* prefix) {
+  const std::size_t length = std::strlen(prefix);
+  return std::size_t(end - p) >= length && std::memcmp(p, prefix, length) == 0;
+}
+
+float Rate(long current, long previous, float seconds) {
+  return current >= previous ? (current - previous) / seconds : 0;
+}
+}  // namespace
+
+NetworkTraffic::NetworkTraffic()
+    : buffer_(64 * 1024),
+      dev_path_(LinuxParser::ProcDirectory() + kNetDevFilename),
+      snmp_path_(LinuxParser::ProcDirectory() + kNetSnmpFilename),
+      sockstat_path_(LinuxParser::ProcDirectory() + kNetSockstatFilename) {
+  socket_fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+}
+
+NetworkTraffic::~NetworkTraffic() {
+  if (socket_fd_ >= 0) close(socket_fd_);
+}
+
+void NetworkTraffic::Update() {
+  const long now = Now();
+  const float seconds =
+      last_update_ns_ > 0 ? (now - last_update_ns_) / 1e9f : 0;
+  last_update_ns_ = now;
+  UpdateDevices(seconds);
+  UpdateSnmp(seconds);
+  UpdateSockstat();
+}
+
+// Reads the whole file into buffer_, growing it only when a file does not
+// fit. The contents are followed by a terminating newline.
+bool NetworkTraffic::Load(const std::string& path) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+  std::size_t size{0};
+  while (1) {
+    if (size + 1 >= buffer_.size()) buffer_.resize(buffer_.size() * 2);
+    const ssize_t received =
+        read(fd, buffer_.data() + size, buffer_.size() - size - 1);
+    if (received <= 0) break;
+    size += received;
+  }
+  close(fd);
+  buffer_[size] = '\n';
+  loaded_ = size;
+  return true;
+}
+
+// Interfaces keep their order in /proc/net/dev, so the slot used at the same
+// position last time is checked before searching. A new interface takes a
+// freed slot before the array grows.
+int NetworkTraffic::Id(const char* name, std::size_t length,
+                       std::size_t hint) {
+  length = std::min<std::size_t>(length, IFNAMSIZ - 1);
+  auto matches = [&](const Interface& interface) {
+    return std::strncmp(interface.name, name, length) == 0 &&
+           interface.name[length] == '\0';
+  };
+  if (hint < interfaces_.size() && matches(interfaces_[hint])) return hint;
+  for (std::size_t id = 0; id < interfaces_.size(); ++id) {
+    if (matches(interfaces_[id])) return id;
+  }
+  Interface interface;
+  std::memcpy(interface.name, name, length);
+  if (!free_ids_.empty()) {
+    const int id = free_ids_.back();
+    free_ids_.pop_back();
+    interfaces_[id] = interface;
+    return id;
+  }
+  interfaces_.push_back(interface);
+  return interfaces_.size() - 1;
+}
+
+void NetworkTraffic::UpdateDevices(float seconds) {
+  for (Interface& interface : interfaces_) interface.present = false;
+  if (!Load(dev_path_)) return;
+  const char* p = buffer_.data();
+  const char* const end = buffer_.data() + loaded_;
+  std::size_t position{0};
+  while (p < end) {
+    const char* line_end = LineEnd(p, end);
+    const char* colon =
+        static_cast<const char*>(std::memchr(p, ':', line_end - p));
+    // The two header lines have no colon
+    if (colon != nullptr) {
+      const char* name = p;
+      while (name < colon && *name == ' ') ++name;
+      Interface& interface = interfaces_[Id(name, colon - name, position++)];
+      // A fresh slot has no previous sample; an interface that really had
+      // zero traffic gets the right rate from zero anyway
+      const bool known = interface.rx_bytes > 0 || interface.tx_bytes > 0;
+      const Interface previous = interface;
+      const char* field = colon + 1;
+      interface.rx_bytes = Next(field, line_end);
+      interface.rx_packets = Next(field, line_end);
+      interface.rx_errors = Next(field, line_end);
+      interface.rx_drops = Next(field, line_end);
+      for (int skip = 0; skip < 4; ++skip) Next(field, line_end);
+      interface.tx_bytes = Next(field, line_end);
+      interface.tx_packets = Next(field, line_end);
+      interface.tx_errors = Next(field, line_end);
+      interface.tx_drops = Next(field, line_end);
+      interface.present = true;
+      if (known && seconds > 0) {
+        interface.rx_bytes_rate =
+            Rate(interface.rx_bytes, previous.rx_bytes, seconds);
+        interface.rx_packets_rate =
+            Rate(interface.rx_packets, previous.rx_packets, seconds);
+        interface.tx_bytes_rate =
+            Rate(interface.tx_bytes, previous.tx_bytes, seconds);
+        interface.tx_packets_rate =
+            Rate(interface.tx_packets, previous.tx_packets, seconds);
+        interface.errors_rate =
+            Rate(interface.rx_errors + interface.tx_errors,
+                 previous.rx_errors + previous.tx_errors, seconds);
+        interface.drops_rate = Rate(interface.rx_drops + interface.tx_drops,
+                                    previous.rx_drops + previous.tx_drops,
+                                    seconds);
+      }
+      // Link state is only asked for interfaces that could be drawn
+      const bool busy = interface.rx_bytes_rate + interface.tx_bytes_rate > 0;
+      interface.up = busy && Up(interface);
+    }
+    p = line_end + 1;
+  }
+  // The slots of interfaces that are gone, such as the veth pairs of stopped
+  // containers, are cleared and reused so churn does not grow the array
+  for (std::size_t id = 0; id < interfaces_.size(); ++id) {
+    Interface& interface = interfaces_[id];
+    if (interface.present || interface.name[0] == '\0') continue;
+    interface = Interface();
+    free_ids_.push_back(id);
+  }
+}
+
+// TCP counters come as a header line of names followed by a line of values
+void NetworkTraffic::UpdateSnmp(float seconds) {
+  if (!Load(snmp_path_)) return;
+  const char* p = buffer_.data();
+  const char* const end = buffer_.data() + loaded_;
+  int column{-1};
+  while (p < end) {
+    const char* line_end = LineEnd(p, end);
+    if (StartsWith(p, line_end, "Tcp:")) {
+      if (column < 0) {
+        const char* name = p + 4;
+        for (column = 0; name < line_end; ++column) {
+          while (name < line_end && *name == ' ') ++name;
+          const char* next = name + std::strlen("RetransSegs");
+          if (StartsWith(name, line_end, "RetransSegs") &&
+              (next == line_end || *next == ' ')) {
+            break;
+          }
+          while (name < line_end && *name != ' ') ++name;
+        }
+      } else {
+        const char* value = p + 4;
+        long retransmits{0};
+        for (int i = 0; i <= column; ++i) {
+          // MaxConn is -1, which Next() reads as 1; only counts matter here
+          retransmits = Next(value, line_end);
+        }
+        if (retransmits_ >= 0 && seconds > 0) {
+          retransmit_rate_ = Rate(retransmits, retransmits_, seconds);
+        }
+        retransmits_ = retransmits;
+        return;
+      }
+    }
+    p = line_end + 1;
+  }
+}
+
+void NetworkTraffic::UpdateSockstat() {
+  if (!Load(sockstat_path_)) return;
+  const char* p = buffer_.data();
+  const char* const end = buffer_.data() + loaded_;
+  while (p < end) {
+    const char* line_end = LineEnd(p, end);
+    const char* field = p;
+    if (StartsWith(p, line_end, "sockets:")) {
+      sockets_used_ = Next(field, line_end);
+    } else if (StartsWith(p, line_end, "TCP:")) {
+      tcp_in_use_ = Next(field, line_end);
+      Next(field, line_end);  // orphan
+      tcp_time_wait_ = Next(field, line_end);
+    } else if (StartsWith(p, line_end, "UDP:")) {
+      udp_in_use_ = Next(field, line_end);
+    }
+    p = line_end + 1;
+  }
+}
+
+bool NetworkTraffic::Up(const Interface& interface) const {
+  if (socket_fd_ < 0) return true;
+  ifreq request{};
+  std::memcpy(request.ifr_name, interface.name, IFNAMSIZ);
+  if (ioctl(socket_fd_, SIOCGIFFLAGS, &request) < 0) return true;
+  return (request.ifr_flags & IFF_UP) && (request.ifr_flags & IFF_RUNNING);
+}
+
+const std::vector<NetworkTraffic::Interface>& NetworkTraffic::Interfaces()
+    const {
+  return interfaces_;
+}
+
+// Interfaces that are up and moved traffic in the last interval, busiest
+// first; active keeps its capacity between calls
+void NetworkTraffic::Active(std::vector<const Interface*>& active) const {
+  active.clear();
+  for (const Interface& interface : interfaces_) {
+    if (interface.present && interface.up) active.push_back(&interface);
+  }
+  std::sort(active.begin(), active.end(),
+            [](const Interface* a, const Interface* b) {
+              return a->rx_bytes_rate + a->tx_bytes_rate >
+                     b->rx_bytes_rate + b->tx_bytes_rate;
+            });
+}
+
+float NetworkTraffic::RetransmitRate() const { return retransmit_rate_; }
+
+long NetworkTraffic::SocketsUsed() const { return sockets_used_; }
+
+long NetworkTraffic::TcpInUse() const { return tcp_in_use_; }
+
+long NetworkTraffic::TcpTimeWait() const { return tcp_time_wait_; }
+
+long NetworkTraffic::UdpInUse() const { return udp_in_use_; }
@@ -0,0 +1,123 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "numa.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+const std::string kNodeDirectory{"/sys/devices/system/node/"};
+
+// Expands a cpulist such as "0-3,8-11" and assigns its CPUs to node
+void AssignCpus(const std::string& cpulist, int node,
+                std::vector<int>& cpu_nodes) {
+  std::istringstream list(cpulist);
+  std::string range;
+  while (std::getline(list, range, ',')) {
+    if (range.empty()) continue;
+    const std::size_t dash = range.find('-');
+    const int first = std::stoi(range.substr(0, dash));
+    const int last =
+        dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    if (last >= static_cast<int>(cpu_nodes.size())) {
+      cpu_nodes.resize(last + 1, -1);
+    }
+    for (int cpu = first; cpu <= last; ++cpu) cpu_nodes[cpu] = node;
+  }
+}
+}  // namespace
+
+NumaTopology::NumaTopology() {
+  DIR* directory = opendir(kNodeDirectory.c_str());
+  if (directory != nullptr) {
+    int highest{-1};
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != nullptr) {
+      const std::string name = entry->d_name;
+      if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+          !std::all_of(name.begin() + 4, name.end(), isdigit)) {
+        continue;
+      }
+      const int node = std::stoi(name.substr(4));
+      std::ifstream stream(kNodeDirectory + name + "/cpulist");
+      std::string cpulist;
+      if (!std::getline(stream, cpulist)) continue;
+      try {
+        AssignCpus(cpulist, node, cpu_nodes_);
+        highest = std::max(highest, node);
+      } catch (const std::logic_error&) {
+        // A malformed list leaves those CPUs without a node
+      }
+    }
+    closedir(directory);
+    nodes_ = std::max(1, highest + 1);
+  }
+  utilization_.resize(nodes_, 0);
+  active_.resize(nodes_, 0);
+  total_.resize(nodes_, 0);
+}
+
+// current_ holds the sample from two updates ago after the swap, so it is
+// cleared first: CPUs that went offline must read as missing, not as that
+// stale sample. CPUs missing from either sample are left out.
+void NumaTopology::Update() {
+  std::fill(current_.begin(), current_.end(), LinuxParser::CpuJiffies());
+  LinuxParser::PerCpuJiffies(current_);
+  std::fill(active_.begin(), active_.end(), 0);
+  std::fill(total_.begin(), total_.end(), 0);
+  auto missing = [](const LinuxParser::CpuJiffies& jiffies) {
+    return jiffies.active == 0 && jiffies.idle == 0;
+  };
+  for (std::size_t cpu = 0; cpu < current_.size(); ++cpu) {
+    if (cpu >= previous_.size()) break;
+    if (missing(current_[cpu]) || missing(previous_[cpu])) continue;
+    const int node = NodeOf(cpu);
+    const long busy = current_[cpu].active - previous_[cpu].active;
+    active_[node] += busy;
+    total_[node] += busy + current_[cpu].idle - previous_[cpu].idle;
+  }
+  for (int node = 0; node < nodes_; ++node) {
+    if (total_[node] > 0) {
+      utilization_[node] = static_cast<float>(active_[node]) / total_[node];
+    }
+  }
+  previous_.swap(current_);
+}
+
+int NumaTopology::Nodes() const { return nodes_; }
+
+// CPUs missing from the topology, e.g. without sysfs, count as node 0
+int NumaTopology::NodeOf(int cpu) const {
+  if (cpu < 0 || cpu >= static_cast<int>(cpu_nodes_.size())) return 0;
+  return std::max(0, cpu_nodes_[cpu]);
+}
+
+float NumaTopology::Utilization(int node) const {
+  return node >= 0 && node < nodes_ ? utilization_[node] : 0;
+}
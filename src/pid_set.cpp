@@ -0,0 +1,123 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pid_set.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux_parser.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#include "directory_entries.h"
+
+namespace {
+const std::size_t kBufferSize{131072};
+const int kWordBits{64};
+// Default of kernel.pid_max on small machines
+const int kDefaultPidMax{32768};
+
+int PidMax() {
+  int pid_max{0};
+  std::ifstream stream(LinuxParser::ProcDirectory() +
+                       LinuxParser::kPidMaxFilename);
+  if (stream >> pid_max && pid_max > 0) return pid_max;
+  return kDefaultPidMax;
+}
+}  // namespace
+
+PidSet::PidSet() : buffer_(kBufferSize) {
+  const std::size_t words = (PidMax() + kWordBits - 1) / kWordBits;
+  current_.resize(words);
+  previous_.resize(words);
+}
+
+// Replaces the set with the PIDs currently under /proc and counts the
+// differences to the previous scan
+void PidSet::Scan() {
+  current_.swap(previous_);
+  std::fill(current_.begin(), current_.end(), 0);
+  pids_.clear();
+  const int directory = open(LinuxParser::ProcDirectory().c_str(),
+                             O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (directory >= 0) {
+    DirectoryEntries::ForEach(
+        directory, buffer_, [this](const char* name, unsigned char type) {
+          // Filesystems that do not fill in d_type, such as some fixture
+          // trees, report DT_UNKNOWN
+          if (type != DT_DIR && type != DT_UNKNOWN) return true;
+          const char* digit = name;
+          int pid{0};
+          for (; *digit >= '0' && *digit <= '9'; ++digit) {
+            pid = pid * 10 + (*digit - '0');
+          }
+          if (*digit == '\0' && digit != name) Insert(pid);
+          return true;
+        });
+    close(directory);
+  }
+  // The list is rebuilt from the bitmap rather than kept in directory
+  // order, so it comes out sorted
+  started_ = 0;
+  exited_ = 0;
+  for (std::size_t word = 0; word < current_.size(); ++word) {
+    const std::uint64_t changed = current_[word] ^ previous_[word];
+    started_ += __builtin_popcountll(changed & current_[word]);
+    exited_ += __builtin_popcountll(changed & previous_[word]);
+    for (std::uint64_t bits = current_[word]; bits != 0; bits &= bits - 1) {
+      pids_.push_back(word * kWordBits + __builtin_ctzll(bits));
+    }
+  }
+}
+
+const std::vector<int>& PidSet::Pids() const { return pids_; }
+
+// Whether pid was seen by the last scan
+bool PidSet::Contains(int pid) const { return Test(current_, pid); }
+
+// Whether pid was seen by the scan before the last one
+bool PidSet::Contained(int pid) const { return Test(previous_, pid); }
+
+int PidSet::Started() const { return started_; }
+
+int PidSet::Exited() const { return exited_; }
+
+// pid_max may be raised at runtime, the bitmaps grow along
+void PidSet::Insert(int pid) {
+  const std::size_t word = pid / kWordBits;
+  if (word >= current_.size()) {
+    current_.resize(word + 1);
+    previous_.resize(word + 1);
+  }
+  current_[word] |= std::uint64_t{1} << (pid % kWordBits);
+}
+
+bool PidSet::Test(const std::vector<std::uint64_t>& bitmap, int pid) {
+  const std::size_t word = pid / kWordBits;
+  return word < bitmap.size() &&
+         (bitmap[word] >> (pid % kWordBits) & 1) != 0;
+}
@@ -0,0 +1,358 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "proc_reader.h"
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <linux_parser.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+// PIDs per batch, so a batch needs kBatch * kNumFiles submission queue
+// entries
+const std::size_t kBatch{256};
+const unsigned kRingEntries{1024};
+// Large enough for the file of any process; status is the long one
+constexpr std::size_t kSlotSizes[] = {1024, 1024, 1024, 4096};
+
+// The slots of one PID lie back to back in the order of kSlotSizes
+constexpr std::array<std::size_t, std::size(kSlotSizes)> SlotOffsets() {
+  std::array<std::size_t, std::size(kSlotSizes)> offsets{};
+  std::size_t offset{0};
+  for (std::size_t i = 0; i < offsets.size(); ++i) {
+    offsets[i] = offset;
+    offset += kSlotSizes[i];
+  }
+  return offsets;
+}
+
+constexpr std::array<std::size_t, std::size(kSlotSizes)> kSlotOffsets =
+    SlotOffsets();
+constexpr std::size_t kPidSize{kSlotOffsets.back() +
+                               kSlotSizes[std::size(kSlotSizes) - 1]};
+const std::size_t kPathSize{256};
+// With io_uring, one scan in this many is read synchronously for comparison
+const long kCompareEvery{10};
+const char* const kFilenames[] = {"stat", "statm", "io", "status"};
+
+long Now() {
+  timespec now{};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+}  // namespace
+
+// Shared memory of one io_uring instance, mapped the way io_uring(7) shows
+struct ProcReader::Ring {
+  int fd{-1};
+  void* sq_ring{MAP_FAILED};
+  std::size_t sq_ring_size{0};
+  void* cq_ring{MAP_FAILED};
+  std::size_t cq_ring_size{0};
+  io_uring_sqe* sqes{static_cast<io_uring_sqe*>(MAP_FAILED)};
+  std::size_t sqes_size{0};
+  unsigned* sq_tail{nullptr};
+  unsigned* sq_mask{nullptr};
+  unsigned* sq_array{nullptr};
+  unsigned* cq_head{nullptr};
+  unsigned* cq_tail{nullptr};
+  unsigned* cq_mask{nullptr};
+  io_uring_cqe* cqes{nullptr};
+  std::vector<int> fds;
+  std::vector<char> paths;
+
+  ~Ring() {
+    if (sqes != MAP_FAILED) munmap(sqes, sqes_size);
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+      munmap(cq_ring, cq_ring_size);
+    }
+    if (sq_ring != MAP_FAILED) munmap(sq_ring, sq_ring_size);
+    if (fd >= 0) close(fd);
+  }
+
+  // False when the kernel has no io_uring or lacks one of the opcodes
+  bool Setup() {
+    io_uring_params params{};
+    fd = syscall(__NR_io_uring_setup, kRingEntries, &params);
+    if (fd < 0) return false;
+    std::vector<char> probe_memory(sizeof(io_uring_probe) +
+                                   256 * sizeof(io_uring_probe_op));
+    io_uring_probe* probe =
+        reinterpret_cast<io_uring_probe*>(probe_memory.data());
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe,
+                256) < 0) {
+      return false;
+    }
+    for (int op : {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE}) {
+      if (op > probe->last_op ||
+          !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+        return false;
+      }
+    }
+
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+      sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+    }
+    sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) return false;
+    cq_ring = sq_ring;
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+      cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+      if (cq_ring == MAP_FAILED) return false;
+    }
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe*>(
+        mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    if (sqes == MAP_FAILED) return false;
+
+    char* sq = static_cast<char*>(sq_ring);
+    char* cq = static_cast<char*>(cq_ring);
+    sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    fds.resize(kBatch * kNumFiles, -1);
+    paths.resize(kBatch * kNumFiles * kPathSize);
+    return true;
+  }
+
+  io_uring_sqe* Next(unsigned& tail) {
+    const unsigned index = tail++ & *sq_mask;
+    sq_array[index] = index;
+    io_uring_sqe* sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+  }
+
+  // Publishes the queued entries up to tail, waits until all of them have
+  // completed and hands every result to complete(user_data, result).
+  // Counts the io_uring_enter calls made in calls. Returns false when
+  // io_uring_enter failed; entries the kernel had already taken are still
+  // waited for, so the descriptors their openat calls return reach
+  // complete() rather than leaking. Entries that were never submitted stay
+  // in the ring, which must not be used again.
+  template <typename Complete>
+  bool Run(unsigned tail, unsigned queued, long& calls, Complete complete) {
+    __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+    unsigned to_submit = queued;
+    unsigned pending = queued;
+    bool failed{false};
+    while (pending > 0) {
+      const unsigned in_flight = pending - to_submit;
+      if (failed && in_flight == 0) break;
+      const int submitted = syscall(
+          __NR_io_uring_enter, fd, failed ? 0 : to_submit,
+          failed ? in_flight : pending, IORING_ENTER_GETEVENTS, nullptr, 0);
+      ++calls;
+      if (submitted < 0 && errno != EINTR && errno != EAGAIN &&
+          errno != EBUSY) {
+        // Waiting failed as well, nothing more can be reaped
+        if (failed) break;
+        failed = true;
+      }
+      if (submitted > 0) to_submit -= submitted;
+      unsigned head = *cq_head;
+      const unsigned ready = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+      for (; head != ready; ++head, --pending) {
+        const io_uring_cqe& cqe = cqes[head & *cq_mask];
+        complete(cqe.user_data, cqe.res);
+      }
+      __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+    return !failed;
+  }
+};
+
+ProcReader::ProcReader(Backend backend)
+    : buffers_(kBatch * kPidSize),
+      lengths_(kBatch * kNumFiles, 0) {
+  static_assert(std::size(kSlotSizes) == kNumFiles, "one slot per file");
+  static_assert(kBatch * kNumFiles <= kRingEntries, "a batch fits the ring");
+  if (backend != kSync) {
+    ring_ = new Ring;
+    if (!ring_->Setup()) {
+      delete ring_;
+      ring_ = nullptr;
+    }
+  }
+}
+
+ProcReader::~ProcReader() { delete ring_; }
+
+char* ProcReader::Buffer(std::size_t slot) {
+  return buffers_.data() + slot / kNumFiles * kPidSize +
+         kSlotOffsets[slot % kNumFiles];
+}
+
+void ProcReader::Path(int pid, File file, char* path) const {
+  std::snprintf(path, kPathSize, "%s%d/%s",
+                LinuxParser::ProcDirectory().c_str(), pid, kFilenames[file]);
+}
+
+// Reads the files of all PIDs batch by batch and calls visit once per PID;
+// the views passed to visit are only valid during the call. With io_uring
+// every kCompareEvery-th scan goes through the synchronous path, so both
+// backends have current figures to compare.
+void ProcReader::Read(
+    const std::vector<int>& pids,
+    const std::function<void(int, const ProcFiles&)>& visit) {
+  const bool sync = ring_ == nullptr || ++scans_ % kCompareEvery == 0;
+  Stats& stats = stats_[sync ? kSync : kUring];
+  stats = Stats{};
+  stats.backend = sync ? "sync" : "io_uring";
+  last_ = &stats;
+  for (std::size_t first = 0; first < pids.size(); first += kBatch) {
+    const std::size_t count = std::min(kBatch, pids.size() - first);
+    const long start = Now();
+    if (sync || ring_ == nullptr) {
+      ReadSync(pids.data() + first, count, stats);
+    } else if (!ReadUring(pids.data() + first, count, stats)) {
+      // The ring is left with entries the kernel never took
+      delete ring_;
+      ring_ = nullptr;
+      ReadSync(pids.data() + first, count, stats);
+    }
+    stats.nanoseconds += Now() - start;
+    for (std::size_t i = 0; i < count; ++i) {
+      auto view = [this, i](File file) {
+        const std::size_t slot = i * kNumFiles + file;
+        return std::string_view(Buffer(slot), lengths_[slot]);
+      };
+      visit(pids[first + i],
+            {view(kStat), view(kStatm), view(kIo), view(kStatus)});
+    }
+  }
+}
+
+void ProcReader::ReadSync(const int* pids, std::size_t count, Stats& stats) {
+  char path[kPathSize];
+  for (std::size_t i = 0; i < count; ++i) {
+    for (int file = 0; file < kNumFiles; ++file) {
+      const std::size_t slot = i * kNumFiles + file;
+      lengths_[slot] = 0;
+      Path(pids[i], static_cast<File>(file), path);
+      const int fd = open(path, O_RDONLY | O_CLOEXEC);
+      ++stats.syscalls;
+      if (fd < 0) continue;
+      const ssize_t length = read(fd, Buffer(slot), kSlotSizes[file]);
+      lengths_[slot] = std::max<ssize_t>(length, 0);
+      close(fd);
+      stats.syscalls += 2;
+    }
+  }
+}
+
+// Three rounds over the whole batch: open every file, read every file that
+// opened, close every descriptor. Returns false when the ring failed; the
+// descriptors opened so far are closed and the batch has to be read again.
+bool ProcReader::ReadUring(const int* pids, std::size_t count, Stats& stats) {
+  Ring& ring = *ring_;
+  const std::size_t slots = count * kNumFiles;
+  unsigned tail = *ring.sq_tail;
+  for (std::size_t slot = 0; slot < slots; ++slot) {
+    char* path = &ring.paths[slot * kPathSize];
+    Path(pids[slot / kNumFiles], static_cast<File>(slot % kNumFiles), path);
+    io_uring_sqe* sqe = ring.Next(tail);
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = reinterpret_cast<uintptr_t>(path);
+    sqe->open_flags = O_RDONLY | O_CLOEXEC;
+    sqe->user_data = slot;
+    lengths_[slot] = 0;
+    ring.fds[slot] = -1;
+  }
+  bool ok = ring.Run(tail, slots, stats.syscalls,
+                     [&ring](uint64_t slot, int result) {
+                       ring.fds[slot] = result;
+                     });
+
+  unsigned queued{0};
+  if (ok) {
+    for (std::size_t slot = 0; slot < slots; ++slot) {
+      if (ring.fds[slot] < 0) continue;
+      io_uring_sqe* sqe = ring.Next(tail);
+      sqe->opcode = IORING_OP_READ;
+      sqe->fd = ring.fds[slot];
+      sqe->addr = reinterpret_cast<uintptr_t>(Buffer(slot));
+      sqe->len = kSlotSizes[slot % kNumFiles];
+      sqe->user_data = slot;
+      ++queued;
+    }
+    ok = ring.Run(tail, queued, stats.syscalls,
+                  [this](uint64_t slot, int result) {
+                    lengths_[slot] = std::max(result, 0);
+                  });
+  }
+
+  if (ok) {
+    queued = 0;
+    for (std::size_t slot = 0; slot < slots; ++slot) {
+      if (ring.fds[slot] < 0) continue;
+      io_uring_sqe* sqe = ring.Next(tail);
+      sqe->opcode = IORING_OP_CLOSE;
+      sqe->fd = ring.fds[slot];
+      sqe->user_data = slot;
+      ++queued;
+    }
+    ok = ring.Run(tail, queued, stats.syscalls,
+                  [&ring](uint64_t slot, int) { ring.fds[slot] = -1; });
+  }
+  // Whatever the ring did not close is closed directly
+  for (std::size_t slot = 0; slot < slots; ++slot) {
+    if (ring.fds[slot] < 0) continue;
+    close(ring.fds[slot]);
+    ring.fds[slot] = -1;
+    ++stats.syscalls;
+  }
+  return ok;
+}
+
+// The most recent scan, whichever backend it used
+const ProcReader::Stats& ProcReader::LastScan() const { return *last_; }
+
+// The most recent scan through backend, with an empty name if there was none
+const ProcReader::Stats& ProcReader::LastScan(Backend backend) const {
+  return stats_[backend];
+}
@@ -25,32 +25,233 @@
 #include <linux_parser.h>
 #include <unistd.h>
 
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
-Process::Process(int pid) {
+#include "string_table.h"
+
+namespace {
+// User names by uid, so /etc/passwd is read once per user rather than once
+// per process
+std::unordered_map<long, StringTable::Id>& UserIds() {
+  static std::unordered_map<long, StringTable::Id> user_ids;
+  return user_ids;
+}
+}  // namespace
+
+namespace {
+// Per second increase of a cumulative counter; previous is -1 before the
+// first sample
+float Rate(long current, long& previous, double interval) {
+  const float rate = previous >= 0 && interval > 0 && current >= previous
+                         ? (current - previous) / interval
+                         : 0;
+  previous = current;
+  return rate;
+}
+}  // namespace
+
+Process::Process(int pid, const ProcFiles& files, long system_uptime) {
   pid_ = pid;
-  command = LinuxParser::Command(pid);
-  user = LinuxParser::User(pid);
-  uptime = LinuxParser::UpTime(pid);
-  ram = LinuxParser::Ram(pid);
+  Update(files, system_uptime, 0);
+}
+
+// Counters come from the files read by ProcReader for the whole scan and
+// rates cover the interval since the previous one. Throws
+// std::out_of_range once the process has exited. Returns false and leaves
+// the process untouched when its PID was reused by a new process, whose
+// start time differs.
+bool Process::Update(const ProcFiles& files, long system_uptime,
+                     double interval) {
+  LinuxParser::ProcessStat stat;
+  if (!LinuxParser::ParseProcessStat(files.stat, stat)) {
+    throw std::out_of_range("process exited");
+  }
+  if (start_time >= 0 && stat.start_time != start_time) return false;
+  start_time = stat.start_time;
+  // exec() changes the comm, and the command line along with it
+  const StringTable::Id comm = Strings().Intern(stat.comm);
+  if (comm != name) command_loaded = false;
+  name = comm;
+  parent_pid = stat.parent_pid;
+  last_cpu = stat.processor;
+  const long own = stat.utime + stat.stime;
+  // cutime and cstime only grow when the process reaps a child, so their
+  // delta is the CPU of children that exited since the last sample
+  const long children = stat.cutime + stat.cstime;
+  children_jiffies_delta =
+      children_jiffies < 0 ? 0 : children - children_jiffies;
+  children_jiffies = children;
+  active_jiffies = own + children;
+  uptime = system_uptime - stat.start_time / sysconf(_SC_CLK_TCK);
   cpu_utilization = Process::CalculateCpuUtilization();
+  ram = LinuxParser::ParseStatmSize(files.statm) / 1000;
+  rss = LinuxParser::ParseStatmResident(files.statm) / 1000;
+  const LinuxParser::ProcessIo io = LinuxParser::ParseProcessIo(files.io);
+  read_bytes = io.read_bytes;
+  write_bytes = io.write_bytes;
+  minor_fault_rate = Rate(stat.minor_faults, minor_faults, interval);
+  major_fault_rate = Rate(stat.major_faults, major_faults, interval);
+  const LinuxParser::ProcessStatus status =
+      LinuxParser::ParseProcessStatus(files.status);
+  voluntary_switch_rate =
+      Rate(status.voluntary_switches, voluntary_switches, interval);
+  involuntary_switch_rate =
+      Rate(status.involuntary_switches, involuntary_switches, interval);
+  // setuid programs change their uid after exec
+  if (status.uid != uid) {
+    uid = status.uid;
+    user_loaded = false;
+  }
+  return true;
+}
+
+StringTable& Process::Strings() {
+  static StringTable strings;
+  return strings;
+}
+
+// Interned strings are never freed, so the names and command lines of
+// exited processes pile up. Once they far outnumber the live processes the
+// strings still in use are moved to a fresh table.
+void Process::CompactStrings(std::vector<Process>& processes) {
+  StringTable& strings = Strings();
+  if (strings.Size() < 4096 || strings.Size() < 8 * processes.size()) return;
+  StringTable compacted;
+  for (Process& process : processes) {
+    process.name = compacted.Intern(strings.Get(process.name));
+    process.command = compacted.Intern(strings.Get(process.command));
+    process.user = compacted.Intern(strings.Get(process.user));
+    process.cgroup = compacted.Intern(strings.Get(process.cgroup));
+  }
+  for (auto& user : UserIds()) {
+    user.second = compacted.Intern(strings.Get(user.second));
+  }
+  strings = std::move(compacted);
 }
 
+// Processes can be moved between cgroups, so membership is re-read on the
+// next access
+void Process::ExpireCgroup() { cgroup_loaded = false; }
+
 int Process::Pid() const { return pid_; }
 
+int Process::ParentPid() const { return parent_pid; }
+
+int Process::LastCpu() const { return last_cpu; }
+
+std::string_view Process::Name() const { return Strings().Get(name); }
+
+// CPU time of the process itself, without that of reaped children
+long Process::OwnJiffies() const { return active_jiffies - children_jiffies; }
+
+long Process::ChildrenJiffiesDelta() const { return children_jiffies_delta; }
+
+long Process::ReadBytes() const { return read_bytes; }
+
+long Process::WriteBytes() const { return write_bytes; }
+
+float Process::MinorFaultRate() const { return minor_fault_rate; }
+
+float Process::MajorFaultRate() const { return major_fault_rate; }
+
+float Process::VoluntarySwitchRate() const { return voluntary_switch_rate; }
+
+float Process::InvoluntarySwitchRate() const {
+  return involuntary_switch_rate;
+}
+
+// Reads /proc/[pid]/schedstat once the previous sample is at least half a
+// second old, so redraws between scans do not shrink the interval to noise
+void Process::SampleSchedStat(long now_ns) const {
+  if (run_ns >= 0 && now_ns - sched_sampled_ns < 500000000) return;
+  const LinuxParser::SchedStat sched = LinuxParser::ProcessSchedStat(pid_);
+  if (sched.run_ns < 0) return;
+  if (run_ns >= 0) {
+    const double elapsed = now_ns - sched_sampled_ns;
+    on_cpu_share = (sched.run_ns - run_ns) / elapsed;
+    run_queue_share = (sched.wait_ns - wait_ns) / elapsed;
+  }
+  run_ns = sched.run_ns;
+  wait_ns = sched.wait_ns;
+  sched_sampled_ns = now_ns;
+}
+
+float Process::OnCpuShare() const { return on_cpu_share; }
+
+float Process::RunQueueShare() const { return run_queue_share; }
+
+// Returns true when the descriptors were listed again. CPU time and context
+// switches are the activity marker; both change whenever the process ran.
+// A denied listing is not retried before then either, while one cut short
+// by the deadline is retried on the next visit.
+bool Process::CountFds(FdScanner& scanner, long deadline_ns) const {
+  const long activity =
+      OwnJiffies() + voluntary_switches + involuntary_switches;
+  if (activity == fds_activity) return false;
+  if (scanner.Count(pid_, deadline_ns, fds) != FdScanner::Result::kTimedOut) {
+    fds_activity = activity;
+  }
+  return true;
+}
+
+const FdScanner::Counts& Process::Fds() const { return fds; }
+
+// Open descriptors as a share of the soft limit, -1 when either is unknown
+float Process::FdLimitShare() const {
+  if (fds.total < 0 || fds.limit <= 0) return -1;
+  return static_cast<float>(fds.total) / fds.limit;
+}
+
 float Process::CalculateCpuUtilization() const {
   // https://stackoverflow.com/questions/16726779/how-do-i-get-the-total-cpu-usage-of-an-application-from-proc-pid-stat/16736599
-  long active_time = LinuxParser::ActiveJiffies(pid_) / sysconf(_SC_CLK_TCK);
+  long active_time = active_jiffies / sysconf(_SC_CLK_TCK);
   long total_time = Process::UpTime();
+  // Processes younger than a second would divide by zero and break sorting
+  if (total_time <= 0) return 0.0;
   return (float)active_time / (float)total_time;
 }
 float Process::CpuUtilization() const { return cpu_utilization; }
 
-std::string Process::Command() const { return command; }
+std::string_view Process::Command() const {
+  if (!command_loaded) {
+    command = Strings().Intern(LinuxParser::Command(pid_));
+    command_loaded = true;
+  }
+  return Strings().Get(command);
+}
 
-std::string Process::Ram() const { return ram; }
+std::string_view Process::Cgroup() const {
+  if (!cgroup_loaded) {
+    cgroup = Strings().Intern(LinuxParser::Cgroup(pid_));
+    cgroup_loaded = true;
+  }
+  return Strings().Get(cgroup);
+}
 
-std::string Process::User() const { return user; }
+long Process::Ram() const { return ram; }
+
+long Process::Rss() const { return rss; }
+
+long Process::Uid() const { return uid; }
+
+std::string_view Process::User() const {
+  if (!user_loaded) {
+    auto known = UserIds().find(uid);
+    if (known == UserIds().end()) {
+      const std::string name =
+          uid < 0 ? "" : LinuxParser::UserName(std::to_string(uid));
+      known = UserIds().emplace(uid, Strings().Intern(name)).first;
+    }
+    user = known->second;
+    user_loaded = true;
+  }
+  return Strings().Get(user);
+}
 
 long int Process::UpTime() const { return uptime; }
 
@@ -24,9 +24,23 @@
 
 #include <linux_parser.h>
 
-float Processor::Utilization() {
+#include <string>
+#include <vector>
+
+void Processor::Update() {
   // https://stackoverflow.com/questions/23367857/accurate-calculation-of-cpu-usage-given-in-percentage-in-linux
-  const long idle = LinuxParser::IdleJiffies();
-  const long total = LinuxParser::Jiffies();
-  return static_cast<float>(total - idle) / total;
-}
\ No newline at end of file
+  // Sampled several times per second, so use the delta since the last sample
+  // instead of the average since boot
+  const LinuxParser::CpuJiffies jiffies = LinuxParser::SystemJiffies();
+  const long active = jiffies.active;
+  const long idle = jiffies.idle;
+  const long active_delta = active - previous_active_;
+  const long total_delta = active_delta + idle - previous_idle_;
+  if (total_delta > 0) {
+    utilization_ = static_cast<float>(active_delta) / total_delta;
+  }
+  previous_active_ = active;
+  previous_idle_ = idle;
+}
+
+float Processor::Utilization() const { return utilization_; }
\ No newline at end of file
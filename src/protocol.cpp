@@ -0,0 +1,178 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "protocol.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+void Put(std::string& out, uint64_t value, int bytes) {
+  for (int i = 0; i < bytes; ++i) {
+    out += static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+void PutFloat(std::string& out, float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  Put(out, bits, 4);
+}
+
+void PutString(std::string& out, std::string_view value) {
+  const std::size_t size = std::min<std::size_t>(value.size(), 0xffff);
+  Put(out, size, 2);
+  out.append(value.data(), size);
+}
+
+// Bounds checked reader over one payload
+class Reader {
+ public:
+  Reader(const char* data, std::size_t size) : data_(data), size_(size) {}
+
+  uint64_t Get(int bytes) {
+    Need(bytes);
+    uint64_t value{0};
+    for (int i = 0; i < bytes; ++i) {
+      value |= uint64_t(static_cast<unsigned char>(data_[offset_ + i]))
+               << (8 * i);
+    }
+    offset_ += bytes;
+    return value;
+  }
+
+  float GetFloat() {
+    const uint32_t bits = Get(4);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  // Points into the payload, callers copy what they keep
+  std::string_view GetString() {
+    const std::size_t size = Get(2);
+    Need(size);
+    std::string_view value(data_ + offset_, size);
+    offset_ += size;
+    return value;
+  }
+
+ private:
+  const char* data_;
+  std::size_t size_;
+  std::size_t offset_{0};
+
+  void Need(std::size_t bytes) const {
+    if (offset_ + bytes > size_) {
+      throw std::runtime_error("truncated snapshot payload");
+    }
+  }
+};
+}  // namespace
+
+// Replaces the contents of frame, reusing its capacity
+void Protocol::Encode(const Snapshot& snapshot, std::string& frame) {
+  frame.clear();
+  Put(frame, kMagic, 4);
+  Put(frame, kVersion, 2);
+  Put(frame, 0, 2);
+  Put(frame, 0, 4);  // payload length, patched below
+  PutString(frame, snapshot.host);
+  PutString(frame, snapshot.os);
+  PutString(frame, snapshot.kernel);
+  PutFloat(frame, snapshot.cpu);
+  PutFloat(frame, snapshot.memory);
+  Put(frame, snapshot.total_processes, 4);
+  Put(frame, snapshot.running_processes, 4);
+  Put(frame, snapshot.uptime, 8);
+  Put(frame, snapshot.processes.size(), 4);
+  for (const ProcessSample& process : snapshot.processes) {
+    Put(frame, process.pid, 4);
+    PutFloat(frame, process.cpu);
+    Put(frame, process.ram, 8);
+    Put(frame, process.uptime, 8);
+    PutString(frame, process.user);
+    PutString(frame, process.command);
+  }
+  const uint32_t payload = frame.size() - kHeaderSize;
+  for (int i = 0; i < 4; ++i) {
+    frame[8 + i] = static_cast<char>((payload >> (8 * i)) & 0xff);
+  }
+}
+
+// Length of the frame starting at data, header included, or 0 while the
+// header is incomplete. Throws std::runtime_error on malformed or
+// unsupported headers.
+std::size_t Protocol::FrameSize(const char* data, std::size_t size) {
+  if (size < kHeaderSize) return 0;
+  Reader header(data, kHeaderSize);
+  if (header.Get(4) != kMagic) throw std::runtime_error("bad frame magic");
+  const uint16_t version = header.Get(2);
+  header.Get(2);
+  const std::size_t payload = header.Get(4);
+  if (version != kVersion) {
+    throw std::runtime_error("unsupported protocol version " +
+                             std::to_string(version));
+  }
+  if (payload > kMaxPayload) throw std::runtime_error("oversized frame");
+  return kHeaderSize + payload;
+}
+
+// Returns the number of bytes consumed, or 0 when the buffer does not hold a
+// complete frame yet. Throws std::runtime_error on malformed or unsupported
+// frames, after which the stream cannot be resynchronised.
+std::size_t Protocol::Decode(const char* data, std::size_t size,
+                             Snapshot& snapshot) {
+  const std::size_t frame = FrameSize(data, size);
+  if (frame == 0 || size < frame) return 0;
+
+  const std::size_t payload = frame - kHeaderSize;
+  Reader reader(data + kHeaderSize, payload);
+  snapshot.strings.Reset();
+  snapshot.host = reader.GetString();
+  snapshot.os = reader.GetString();
+  snapshot.kernel = reader.GetString();
+  snapshot.cpu = reader.GetFloat();
+  snapshot.memory = reader.GetFloat();
+  snapshot.total_processes = static_cast<int32_t>(reader.Get(4));
+  snapshot.running_processes = static_cast<int32_t>(reader.Get(4));
+  snapshot.uptime = static_cast<int64_t>(reader.Get(8));
+  const std::size_t count = reader.Get(4);
+  // Every sample takes at least 28 bytes, so a bogus count cannot make the
+  // vector grow past what the payload could describe
+  if (count * 28 > payload) throw std::runtime_error("bad process count");
+  snapshot.processes.resize(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    ProcessSample& process = snapshot.processes[i];
+    process.pid = static_cast<int32_t>(reader.Get(4));
+    process.cpu = reader.GetFloat();
+    process.ram = static_cast<int64_t>(reader.Get(8));
+    process.uptime = static_cast<int64_t>(reader.Get(8));
+    process.user = snapshot.strings.Copy(reader.GetString());
+    process.command = snapshot.strings.Copy(reader.GetString());
+  }
+  return kHeaderSize + payload;
+}
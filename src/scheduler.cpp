@@ -0,0 +1,150 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "scheduler.h"
+
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+namespace {
+const int kMaxBackoff{16};
+// Weight of the newest sample in the smoothed collection cost
+const float kCostSmoothing{0.25};
+
+long ProcessCpuNanoseconds() {
+  timespec now{};
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+}  // namespace
+
+Scheduler::Scheduler(std::chrono::milliseconds tick, float budget)
+    : tick_ns_(std::chrono::nanoseconds(tick).count()), budget_(budget) {
+  // Default refresh rates; cmdline and user are only read for new PIDs
+  Period(kCpu, std::chrono::milliseconds(250));
+  Period(kPressure, std::chrono::milliseconds(250));
+  Period(kMemory, std::chrono::seconds(1));
+  Period(kProcesses, std::chrono::seconds(1));
+  Period(kCgroups, std::chrono::seconds(10));
+  Period(kNetwork, std::chrono::seconds(1));
+
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+  if (timer_fd_ < 0) {
+    throw std::system_error(errno, std::generic_category(), "timerfd_create");
+  }
+  fds_.push_back({timer_fd_, POLLIN, 0});
+  // Absolute expirations on a fixed interval, so slow frames never drift
+  itimerspec spec{};
+  spec.it_interval.tv_sec = tick_ns_ / 1000000000L;
+  spec.it_interval.tv_nsec = tick_ns_ % 1000000000L;
+  spec.it_value = spec.it_interval;
+  if (timerfd_settime(timer_fd_, 0, &spec, nullptr) < 0) {
+    const int error = errno;
+    close(timer_fd_);
+    throw std::system_error(error, std::generic_category(), "timerfd_settime");
+  }
+}
+
+Scheduler::~Scheduler() {
+  if (timer_fd_ >= 0) close(timer_fd_);
+}
+
+void Scheduler::Period(Metric metric, std::chrono::milliseconds period) {
+  const long ticks = std::chrono::nanoseconds(period).count() / tick_ns_;
+  period_ticks_[metric] = std::max(1L, ticks);
+}
+
+void Scheduler::WakeOn(int fd) { fds_.push_back({fd, POLLIN, 0}); }
+
+void Scheduler::Forget(int fd) {
+  auto watched = [fd](const pollfd& entry) { return entry.fd == fd; };
+  fds_.erase(std::remove_if(fds_.begin() + 1, fds_.end(), watched),
+             fds_.end());
+}
+
+// Blocks until the next tick and returns the metrics that are due.
+// The first call reports every metric so the display starts fully populated.
+unsigned Scheduler::Wait() {
+  due_ = 0;
+  if (ticks_ > 0) {
+    // A signal such as SIGWINCH also wakes the caller early
+    if (poll(fds_.data(), fds_.size(), -1) < 0) return 0;
+    if (!(fds_[0].revents & POLLIN)) return 0;
+    uint64_t expirations{0};
+    while (read(timer_fd_, &expirations, sizeof(expirations)) < 0 &&
+           errno == EINTR) {
+    }
+    ticks_ += expirations;
+  } else {
+    ticks_ = 1;
+  }
+  unsigned due{0};
+  for (int metric = 0; metric < kNumMetrics; ++metric) {
+    if (ticks_ >= next_due_[metric]) {
+      due |= 1u << metric;
+      next_due_[metric] = ticks_ + period_ticks_[metric] * backoff_;
+    }
+  }
+  due_ = due;
+  return due;
+}
+
+void Scheduler::BeginCollection() {
+  collection_start_ns_ = ProcessCpuNanoseconds();
+}
+
+// Only collections on a tick with metrics due are sampled. Early wakeups
+// for input, scrapes or process events collect next to nothing, and
+// counting them would pull the cost down just while the load is high.
+// The cost is spread over the ticks since the previous sample, which is
+// more than one when expirations were missed.
+void Scheduler::EndCollection() {
+  if (due_ == 0) return;
+  const long spent = ProcessCpuNanoseconds() - collection_start_ns_;
+  const unsigned long elapsed = std::max(1UL, ticks_ - sampled_ticks_);
+  sampled_ticks_ = ticks_;
+  const float sample = static_cast<float>(spent) / (elapsed * tick_ns_);
+  cost_ = kCostSmoothing * sample + (1 - kCostSmoothing) * cost_;
+  // Halve the sampling rate while over budget, recover once well under it
+  if (cost_ > budget_ && backoff_ < kMaxBackoff) {
+    backoff_ *= 2;
+    cost_ /= 2;
+  } else if (cost_ < budget_ / 4 && backoff_ > 1) {
+    backoff_ /= 2;
+    cost_ *= 2;
+  }
+}
+
+int Scheduler::Backoff() const { return backoff_; }
+
+bool Scheduler::Due(unsigned metrics, Metric metric) {
+  return metrics & (1u << metric);
+}
+
+unsigned Scheduler::All() { return (1u << kNumMetrics) - 1; }
@@ -0,0 +1,134 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "streaming_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Sorts the at most four samples seen before the markers exist. std::sort
+// unrolls its insertion sort past such a short range, which GCC reports
+// as out of bounds.
+void InsertionSort(double* first, long count) {
+  for (long i = 1; i < count; ++i) {
+    const double value = first[i];
+    long j = i;
+    for (; j > 0 && first[j - 1] > value; --j) first[j] = first[j - 1];
+    first[j] = value;
+  }
+}
+}  // namespace
+
+StreamingStats::StreamingStats(double quantile, double window_seconds)
+    : p_(quantile), window_(window_seconds) {}
+
+void StreamingStats::Add(double value, double seconds) {
+  // A sample covering more time moves the average further
+  if (count_ == 0) {
+    mean_ = value;
+  } else {
+    const double alpha = 1 - std::exp(-seconds / window_);
+    const double difference = value - mean_;
+    mean_ += alpha * difference;
+    variance_ = (1 - alpha) * (variance_ + alpha * difference * difference);
+  }
+  seconds_ += seconds;
+
+  // The first five samples become the markers
+  if (count_ < 5) {
+    heights_[count_++] = value;
+    if (count_ == 5) {
+      std::sort(heights_, heights_ + 5);
+      const double desired[5] = {1, 1 + 2 * p_, 1 + 4 * p_, 3 + 2 * p_, 5};
+      for (int i = 0; i < 5; ++i) {
+        positions_[i] = i + 1;
+        desired_[i] = desired[i];
+      }
+    }
+    return;
+  }
+  ++count_;
+  int cell;
+  if (value < heights_[0]) {
+    heights_[0] = value;
+    cell = 0;
+  } else if (value >= heights_[4]) {
+    heights_[4] = value;
+    cell = 3;
+  } else {
+    cell = std::upper_bound(heights_ + 1, heights_ + 4, value) - heights_ - 1;
+  }
+  for (int i = cell + 1; i < 5; ++i) positions_[i] += 1;
+  const double increments[5] = {0, p_ / 2, p_, (1 + p_) / 2, 1};
+  for (int i = 0; i < 5; ++i) desired_[i] += increments[i];
+  // Middle markers that drifted from their desired position by a whole
+  // step move one position, along a parabola through their neighbours
+  for (int i = 1; i < 4; ++i) {
+    const double drift = desired_[i] - positions_[i];
+    if ((drift >= 1 && positions_[i + 1] - positions_[i] > 1) ||
+        (drift <= -1 && positions_[i - 1] - positions_[i] < -1)) {
+      const int d = drift > 0 ? 1 : -1;
+      const double height = Parabolic(i, d);
+      heights_[i] = heights_[i - 1] < height && height < heights_[i + 1]
+                        ? height
+                        : Linear(i, d);
+      positions_[i] += d;
+    }
+  }
+}
+
+double StreamingStats::Parabolic(int i, double d) const {
+  const double* q = heights_;
+  const double* n = positions_;
+  return q[i] + d / (n[i + 1] - n[i - 1]) *
+                    ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) /
+                         (n[i + 1] - n[i]) +
+                     (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) /
+                         (n[i] - n[i - 1]));
+}
+
+double StreamingStats::Linear(int i, int d) const {
+  return heights_[i] + d * (heights_[i + d] - heights_[i]) /
+                           (positions_[i + d] - positions_[i]);
+}
+
+long StreamingStats::Count() const { return count_; }
+
+double StreamingStats::Seconds() const { return seconds_; }
+
+double StreamingStats::Mean() const { return mean_; }
+
+double StreamingStats::Variance() const { return variance_; }
+
+double StreamingStats::StdDev() const { return std::sqrt(variance_); }
+
+// Exact over the first samples, estimated afterwards
+double StreamingStats::Quantile() const {
+  if (count_ == 0) return 0;
+  if (count_ >= 5) return heights_[2];
+  double sorted[4];
+  std::copy(heights_, heights_ + count_, sorted);
+  InsertionSort(sorted, count_);
+  return sorted[std::min<long>(count_ - 1, std::lround(p_ * (count_ - 1)))];
+}
@@ -0,0 +1,47 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "string_table.h"
+
+#include <string_view>
+
+StringTable::StringTable() : strings_{std::string_view()} {}
+
+// The map is keyed by views into the arena, so looking up a string that is
+// already interned does not allocate
+StringTable::Id StringTable::Intern(std::string_view text) {
+  if (text.empty()) return kEmpty;
+  auto known = ids_.find(text);
+  if (known != ids_.end()) return known->second;
+  const std::string_view stored = storage_.Copy(text);
+  const Id id = strings_.size();
+  strings_.push_back(stored);
+  ids_.emplace(stored, id);
+  return id;
+}
+
+std::string_view StringTable::Get(Id id) const {
+  return id < strings_.size() ? strings_[id] : std::string_view();
+}
+
+std::size_t StringTable::Size() const { return strings_.size(); }
@@ -23,42 +23,250 @@
 #include "system.h"
 
 #include <linux_parser.h>
+#include <time.h>
 
+#include <algorithm>
+#include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "process.h"
 #include "processor.h"
+#include "scheduler.h"
 
-System::System() {
+namespace {
+// Time per refresh for counting descriptors beyond the rows on screen
+const long kFdBudgetNs{2000000};
+
+long Now() {
+  timespec now{};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+}  // namespace
+
+System::System(ProcReader::Backend backend,
+               const std::vector<std::string>& alert_rules)
+    : alerts_(alert_rules), reader_(backend) {
   kernel_ = LinuxParser::Kernel();
   os_ = LinuxParser::OperatingSystem();
 }
+
+// Only the metrics flagged by the scheduler are re-read, everything else
+// keeps the value from its last refresh
+void System::Refresh(unsigned metrics) {
+  exits_.Poll();
+  if (Scheduler::Due(metrics, Scheduler::kCpu)) {
+    cpu_.Update();
+    numa_.Update();
+  }
+  if (Scheduler::Due(metrics, Scheduler::kPressure)) {
+    cpu_pressure_ = LinuxParser::CpuPressure();
+  }
+  if (Scheduler::Due(metrics, Scheduler::kProcesses)) {
+    const long now = Now();
+    scan_interval_ = last_scan_ns_ > 0 ? (now - last_scan_ns_) / 1e9 : 0;
+    last_scan_ns_ = now;
+    uptime_ = LinuxParser::UpTime();
+    UpdateProcesses();
+    total_processes_ = LinuxParser::TotalProcesses();
+    running_processes_ = LinuxParser::RunningProcesses();
+    const long switches = LinuxParser::ContextSwitches();
+    const long faults = LinuxParser::MajorFaults();
+    const long delay = LinuxParser::RunQueueDelay();
+    if (scan_interval_ > 0) {
+      context_switch_rate_ = (switches - context_switches_) / scan_interval_;
+      major_fault_rate_ = (faults - major_faults_) / scan_interval_;
+      if (delay >= 0 && run_queue_delay_ >= 0) {
+        run_queue_delay_rate_ = (delay - run_queue_delay_) / scan_interval_;
+      }
+    }
+    context_switches_ = switches;
+    major_faults_ = faults;
+    run_queue_delay_ = delay;
+    open_files_ = LinuxParser::OpenFiles();
+    alerts_.Update(processes_, cpu_.Utilization(), memory_utilization_,
+                   cpu_pressure_);
+  }
+  if (Scheduler::Due(metrics, Scheduler::kCgroups)) {
+    for (Process& process : processes_) process.ExpireCgroup();
+  }
+  if (Scheduler::Due(metrics, Scheduler::kMemory)) {
+    memory_utilization_ = LinuxParser::MemoryUtilization();
+  }
+  if (Scheduler::Due(metrics, Scheduler::kNetwork)) network_.Update();
+}
+
 Processor& System::Cpu() { return cpu_; }
 
-std::vector<Process>& System::Processes() {
-  processes_.clear();
-  std::vector<int> pids = LinuxParser::Pids();
-  for (int pid : pids) {
+ExitTracker& System::Exits() { return exits_; }
+
+const Alerts& System::Alerting() const { return alerts_; }
+
+const NetworkTraffic& System::Network() const { return network_; }
+
+const NumaTopology& System::Numa() const { return numa_; }
+
+const ProcReader& System::ProcScan() const { return reader_; }
+
+const PidSet& System::Pids() const { return pids_; }
+
+// Processes seen on the previous scan are carried over and only their
+// counters are re-read; new PIDs are parsed in full. The per-process files
+// of all PIDs are read in batches by ProcReader. Lookup tables live in the
+// tick arena and the process vectors are swapped rather than reallocated,
+// so a steady state scan does not allocate.
+void System::UpdateProcesses() {
+  tick_.Reset();
+  const std::size_t count = processes_.size();
+  std::pair<int, std::size_t>* previous =
+      tick_.Allocate<std::pair<int, std::size_t>>(count);
+  bool* alive = tick_.Allocate<bool>(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    previous[i] = {processes_[i].Pid(), i};
+    alive[i] = false;
+  }
+  std::sort(previous, previous + count);
+  std::vector<Process>& current = scratch_;
+  current.clear();
+  pids_.Scan();
+  auto visit = [&](int pid, const ProcFiles& files) {
     try {
-      auto process = Process(pid);
-      processes_.push_back(process);
+      // Only PIDs present on the previous scan can have a Process
+      if (!pids_.Contained(pid)) {
+        current.emplace_back(pid, files, uptime_);
+        return;
+      }
+      auto known = std::lower_bound(
+          previous, previous + count, std::make_pair(pid, std::size_t{0}));
+      // A PID reused since the last scan is a new process; the old one is
+      // reported as exited
+      if (known != previous + count && known->first == pid &&
+          processes_[known->second].Update(files, uptime_, scan_interval_)) {
+        Process& process = processes_[known->second];
+        alive[known->second] = true;
+        exits_.Reaped(process);
+        current.push_back(std::move(process));
+      } else {
+        current.emplace_back(pid, files, uptime_);
+      }
     } catch (std::exception& e) {
       // Do nothing
     }
+  };
+  // A reference wrapper fits std::function's small buffer, the lambda with
+  // its captures would be copied to the heap
+  reader_.Read(pids_.Pids(), std::ref(visit));
+  for (std::size_t i = 0; i < count; ++i) {
+    if (!alive[i]) exits_.Exited(processes_[i]);
   }
+  exits_.EndTick();
+  processes_.swap(current);
   std::sort(processes_.rbegin(), processes_.rend());
-  return processes_;
+  Process::CompactStrings(processes_);
 }
 
+std::vector<Process>& System::Processes() { return processes_; }
+
 std::string System::Kernel() { return kernel_; }
 
-float System::MemoryUtilization() { return LinuxParser::MemoryUtilization(); }
+float System::MemoryUtilization() { return memory_utilization_; }
+
+float System::CpuPressure() { return cpu_pressure_; }
 
 std::string System::OperatingSystem() { return os_; }
 
-int System::RunningProcesses() { return LinuxParser::RunningProcesses(); }
+int System::RunningProcesses() { return running_processes_; }
+
+int System::TotalProcesses() { return total_processes_; }
+
+float System::ContextSwitchRate() const { return context_switch_rate_; }
+
+float System::MajorFaultRate() const { return major_fault_rate_; }
+
+// Nanoseconds per second that tasks spent runnable but waiting for a CPU,
+// summed over all CPUs; -1 without /proc/schedstat
+float System::RunQueueDelay() const { return run_queue_delay_rate_; }
+
+// Per process scheduler statistics cost a file read each, so they are only
+// sampled for the rows the caller shows, such as the visible slice of a
+// filtered and sorted table
+void System::SampleSchedStats(const std::vector<const Process*>& processes,
+                              std::size_t first, std::size_t count) {
+  const long now = Now();
+  const std::size_t end = std::min(processes.size(), first + count);
+  for (std::size_t i = first; i < end; ++i) {
+    processes[i]->SampleSchedStat(now);
+  }
+}
+
+// Runs before the table is sorted, so a sort by descriptor use sees the new
+// counts. The rows last shown go first and the rest of the budget goes
+// round-robin through the other processes in PID order, so every process
+// is eventually covered. Rows on screen that do not fit the budget are the
+// first ones counted next time.
+void System::CountFds(const std::vector<int>& shown) {
+  const long deadline = Now() + kFdBudgetNs;
+  fd_order_.clear();
+  for (const Process& process : processes_) fd_order_.push_back(&process);
+  auto by_pid = [](const Process* process, int pid) {
+    return process->Pid() < pid;
+  };
+  std::sort(fd_order_.begin(), fd_order_.end(),
+            [](const Process* a, const Process* b) {
+              return a->Pid() < b->Pid();
+            });
+  std::size_t counted{0};
+  for (; counted < shown.size() && Now() < deadline; ++counted) {
+    const int pid = shown[(fd_next_shown_ + counted) % shown.size()];
+    auto process =
+        std::lower_bound(fd_order_.begin(), fd_order_.end(), pid, by_pid);
+    if (process != fd_order_.end() && (*process)->Pid() == pid) {
+      (*process)->CountFds(fd_scanner_, deadline);
+    }
+  }
+  fd_next_shown_ =
+      shown.empty() ? 0 : (fd_next_shown_ + counted) % shown.size();
+  auto next = std::lower_bound(fd_order_.begin(), fd_order_.end(),
+                               fd_next_pid_, by_pid);
+  for (std::size_t visited = 0;
+       visited < fd_order_.size() && Now() < deadline; ++visited) {
+    if (next == fd_order_.end()) next = fd_order_.begin();
+    (*next)->CountFds(fd_scanner_, deadline);
+    fd_next_pid_ = (*next++)->Pid() + 1;
+  }
+}
 
-int System::TotalProcesses() { return LinuxParser::TotalProcesses(); }
+const LinuxParser::FileHandles& System::OpenFiles() const {
+  return open_files_;
+}
+
+long int System::UpTime() { return uptime_; }
 
-long int System::UpTime() { return LinuxParser::UpTime(); }
\ No newline at end of file
+// Copies the system counters and the top processes by CPU into snapshot,
+// reusing its storage; only those processes have their lazy fields resolved
+void System::TakeSnapshot(const std::string& host, std::size_t top,
+                          Snapshot& snapshot) {
+  snapshot.host = host;
+  snapshot.os = os_;
+  snapshot.kernel = kernel_;
+  snapshot.cpu = cpu_.Utilization();
+  snapshot.memory = memory_utilization_;
+  snapshot.total_processes = total_processes_;
+  snapshot.running_processes = running_processes_;
+  snapshot.uptime = uptime_;
+  snapshot.strings.Reset();
+  const std::size_t count = std::min(top, processes_.size());
+  snapshot.processes.resize(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const Process& process = processes_[i];
+    ProcessSample& sample = snapshot.processes[i];
+    sample.pid = process.Pid();
+    sample.cpu = process.CpuUtilization();
+    sample.ram = process.Ram();
+    sample.uptime = process.UpTime();
+    sample.user = snapshot.strings.Copy(process.User());
+    sample.command = snapshot.strings.Copy(process.Command());
+  }
+}
@@ -0,0 +1,118 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "alerts.h"
+#include "check.h"
+#include "proc_reader.h"
+#include "process.h"
+
+namespace {
+bool Rejected(const std::string& rule) {
+  try {
+    Alerts alerts({rule});
+  } catch (const std::invalid_argument&) {
+    return true;
+  }
+  return false;
+}
+
+void ValidRules() {
+  Alerts alerts({"cpu > 80", "io > 1024", "ram grows 20% over 5m",
+                 "cpu > p99 + 3sigma", "cpu > p95 over 1h",
+                 "system memory > 90", "system pressure > 10",
+                 "system cpu > p99 + 2.5sigma over 30s"});
+  CHECK(alerts.Firing().empty());
+}
+
+void MalformedRules() {
+  CHECK(Rejected(""));
+  CHECK(Rejected("disk > 5"));
+  CHECK(Rejected("system ram > 5"));
+  CHECK(Rejected("memory > 5"));
+  CHECK(Rejected("cpu"));
+  CHECK(Rejected("cpu >"));
+  CHECK(Rejected("cpu > lots"));
+  CHECK(Rejected("cpu < 5"));
+  CHECK(Rejected("cpu > 80 now"));
+  CHECK(Rejected("cpu > p100"));
+  CHECK(Rejected("cpu > p0"));
+  CHECK(Rejected("cpu > p99 + 3"));
+  CHECK(Rejected("cpu > p99 - 3sigma"));
+  CHECK(Rejected("ram grows 20 over 5m"));
+  CHECK(Rejected("ram grows 20% during 5m"));
+  CHECK(Rejected("ram grows 20% over 5d"));
+  CHECK(Rejected("ram grows 20% over"));
+}
+
+// System rules fire and resolve with the values passed in
+void SystemRule() {
+  Alerts alerts({"system memory > 40"});
+  const std::vector<Process> none;
+  alerts.Update(none, 0, 0.5, 0);
+  CHECK(alerts.Firing().size() == 1);
+  CHECK(alerts.Started().size() == 1);
+  CHECK(alerts.Firing()[0].subject == "system");
+  CHECK(alerts.Firing()[0].value == 50);
+  alerts.Update(none, 0, 0.5, 0);
+  CHECK(alerts.Started().empty());
+  alerts.Update(none, 0, 0.3, 0);
+  CHECK(alerts.Firing().empty());
+  CHECK(alerts.Resolved().size() == 1);
+}
+
+// ram rules see the resident set, not the virtual size: this process
+// reserves 100 MB of address space and has nothing resident at first
+void ResidentMemory() {
+  const std::string stat =
+      "100 (server) S 1 100 100 0 -1 4194304 500 0 2 0 3000 1000 0 0 20 0 "
+      "1 0 5000 104857600 0\n";
+  std::vector<Process> processes;
+  processes.emplace_back(100, ProcFiles{stat, "25600 0 0 10 0 1000 0\n",
+                                        "", "Uid:\t0\t0\t0\t0\n"},
+                         1000);
+  CHECK(processes[0].Ram() > 100);
+  CHECK(processes[0].Rss() == 0);
+  Alerts alerts({"ram > 1"});
+  alerts.Update(processes, 0, 0, 0);
+  CHECK(!alerts.Firing(100));
+
+  // Once 2560 pages, at least 10 MB, are resident the rule fires
+  processes[0].Update({stat, "25600 2560 0 10 0 1000 0\n", "",
+                       "Uid:\t0\t0\t0\t0\n"},
+                      1000, 1);
+  CHECK(processes[0].Rss() >= 10);
+  alerts.Update(processes, 0, 0, 0);
+  CHECK(alerts.Firing(100));
+}
+}  // namespace
+
+int main() {
+  ValidRules();
+  MalformedRules();
+  SystemRule();
+  ResidentMemory();
+  return 0;
+}
@@ -0,0 +1,99 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <execinfo.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "check.h"
+#include "linux_parser.h"
+#include "scheduler.h"
+#include "system.h"
+
+// glibc lets the executable replace malloc; operator new goes through it
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* pointer, std::size_t size);
+}
+
+namespace {
+bool counting{false};
+long allocations{0};
+
+void Count() {
+  if (!counting) return;
+  ++allocations;
+  // ALLOCATION_TRACE=1 prints where each allocation comes from
+  if (std::getenv("ALLOCATION_TRACE") != nullptr) {
+    counting = false;
+    void* frames[16];
+    const int depth = backtrace(frames, 16);
+    backtrace_symbols_fd(frames, depth, STDERR_FILENO);
+    write(STDERR_FILENO, "\n", 1);
+    counting = true;
+  }
+}
+}  // namespace
+
+extern "C" {
+void* malloc(std::size_t size) {
+  Count();
+  return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) {
+  Count();
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, std::size_t size) {
+  Count();
+  return __libc_realloc(pointer, size);
+}
+}
+
+// usage: allocation_test FIXTURE_PROC_ROOT
+// Refreshes every metric against a fixture tree and requires that ticks
+// after the warm-up do not allocate
+int main(int argc, char* argv[]) {
+  CHECK(argc == 2);
+  LinuxParser::SetProcDirectory(argv[1]);
+  System system(ProcReader::kAuto,
+                {"ram grows 20% over 5m", "system cpu > p99 + 3sigma"});
+  const unsigned all = (1u << Scheduler::kNumMetrics) - 1;
+  for (int tick = 0; tick < 3; ++tick) system.Refresh(all);
+  counting = true;
+  for (int tick = 0; tick < 10; ++tick) system.Refresh(all);
+  counting = false;
+  if (allocations != 0) {
+    std::fprintf(stderr, "%ld allocations in 10 steady state ticks\n",
+                 allocations);
+  }
+  CHECK(allocations == 0);
+  return 0;
+}
@@ -0,0 +1,100 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "check.h"
+#include "fd_scanner.h"
+#include "linux_parser.h"
+
+namespace {
+const long kLater{1L << 62};
+
+void WriteLimits(const std::string& root, const char* soft) {
+  std::ofstream(root + "100/limits")
+      << "Limit                     Soft Limit           Hard Limit           "
+         "Units     \n"
+      << "Max processes             63704                63704                "
+         "processes \n"
+      << "Max open files            " << soft
+      << "                 524288               files     \n";
+}
+}  // namespace
+
+// Descriptors are told apart by their link target, the limit comes from
+// the limits file of the proc root and a listing stops at its deadline
+int main() {
+  char directory[] = "/tmp/fd_scanner_test.XXXXXX";
+  CHECK(mkdtemp(directory) != nullptr);
+  const std::string root = std::string(directory) + "/";
+  const std::string fd = root + "100/fd/";
+  CHECK(mkdir((root + "100").c_str(), 0755) == 0);
+  CHECK(mkdir(fd.c_str(), 0755) == 0);
+  LinuxParser::SetProcDirectory(root);
+
+  const int kDescriptors{300};
+  for (int i = 0; i < kDescriptors; ++i) {
+    const char* target = i % 3 == 0   ? "socket:[1234]"
+                         : i % 3 == 1 ? "pipe:[5678]"
+                                      : "/var/log/syslog";
+    CHECK(symlink(target, (fd + std::to_string(i)).c_str()) == 0);
+  }
+  CHECK(symlink("anon_inode:[eventfd]", (fd + "300").c_str()) == 0);
+  WriteLimits(root, "1024");
+
+  FdScanner scanner;
+  FdScanner::Counts counts;
+  CHECK(scanner.Count(100, kLater, counts) == FdScanner::Result::kCounted);
+  CHECK(counts.total == kDescriptors + 1);
+  CHECK(counts.sockets == kDescriptors / 3);
+  CHECK(counts.pipes == kDescriptors / 3);
+  CHECK(counts.files == kDescriptors / 3);
+  CHECK(counts.limit == 1024);
+
+  WriteLimits(root, "unlimited");
+  CHECK(scanner.Count(100, kLater, counts) == FdScanner::Result::kCounted);
+  CHECK(counts.limit == -1);
+
+  // A deadline that passed abandons the listing and keeps the old counts
+  WriteLimits(root, "1024");
+  CHECK(scanner.Count(100, 0, counts) == FdScanner::Result::kTimedOut);
+  CHECK(counts.total == kDescriptors + 1);
+  CHECK(counts.limit == -1);
+
+  // A process that is gone may not be listed
+  CHECK(scanner.Count(101, kLater, counts) == FdScanner::Result::kDenied);
+  CHECK(counts.total == kDescriptors + 1);
+
+  for (int i = 0; i <= kDescriptors; ++i) {
+    unlink((fd + std::to_string(i)).c_str());
+  }
+  rmdir(fd.c_str());
+  unlink((root + "100/limits").c_str());
+  rmdir((root + "100").c_str());
+  rmdir(directory);
+  return 0;
+}
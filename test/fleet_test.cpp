@@ -0,0 +1,146 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "check.h"
+
+namespace {
+const long kTimeoutMs{15000};
+
+// Starts argv[0] with stdout sent to output, or inherited when output < 0
+pid_t Spawn(const std::vector<std::string>& args, int output) {
+  const pid_t pid = fork();
+  CHECK(pid >= 0);
+  if (pid == 0) {
+    if (output >= 0) dup2(output, STDOUT_FILENO);
+    std::vector<char*> argv;
+    for (const std::string& arg : args) {
+      argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    execv(argv[0], argv.data());
+    _exit(127);
+  }
+  return pid;
+}
+
+void Stop(pid_t pid) {
+  kill(pid, SIGTERM);
+  waitpid(pid, nullptr, 0);
+}
+
+long Now() {
+  timespec now{};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+// Reads the aggregator's output until a report with both nodes online is
+// complete and returns that report
+std::string AwaitReport(int fd) {
+  std::string output;
+  const long deadline = Now() + kTimeoutMs;
+  while (Now() < deadline) {
+    const std::size_t start = output.rfind("Nodes: 2/2");
+    if (start != std::string::npos) {
+      const std::size_t end = output.find("\n\n", start);
+      if (end != std::string::npos) return output.substr(start, end - start);
+    }
+    pollfd ready{fd, POLLIN, 0};
+    if (poll(&ready, 1, 100) <= 0) continue;
+    char buffer[4096];
+    const ssize_t size = read(fd, buffer, sizeof(buffer));
+    if (size <= 0) break;
+    output.append(buffer, size);
+  }
+  std::fprintf(stderr, "aggregator output:\n%s\n", output.c_str());
+  return "";
+}
+
+// The report line of a process, empty when it is not listed
+std::string Line(const std::string& report, const std::string& text) {
+  const std::size_t found = report.find(text);
+  if (found == std::string::npos) return "";
+  const std::size_t start = report.rfind('\n', found) + 1;
+  return report.substr(start, report.find('\n', found) - start);
+}
+}  // namespace
+
+// usage: fleet_test MONITOR FIXTURES
+int main(int argc, char* argv[]) {
+  CHECK(argc == 3);
+  const std::string monitor = argv[1];
+  const std::string fixtures = argv[2];
+  char directory[] = "/tmp/fleet_testXXXXXX";
+  CHECK(mkdtemp(directory) != nullptr);
+  const std::string socket_a = std::string("unix:") + directory + "/a.sock";
+  const std::string socket_b = std::string("unix:") + directory + "/b.sock";
+
+  const pid_t collector_a =
+      Spawn({monitor, "--proc-root", fixtures + "/proc_a/", "--collect",
+             socket_a, "--name", "node-a", "--top", "5"},
+            -1);
+  const pid_t collector_b =
+      Spawn({monitor, "--proc-root", fixtures + "/proc_b/", "--collect",
+             socket_b, "--name", "node-b", "--top", "5"},
+            -1);
+  int output[2];
+  CHECK(pipe(output) == 0);
+  const pid_t aggregator = Spawn(
+      {monitor, "--aggregate", socket_a, socket_b, "--top", "3"}, output[1]);
+  close(output[1]);
+
+  const std::string report = AwaitReport(output[0]);
+  Stop(aggregator);
+  Stop(collector_a);
+  Stop(collector_b);
+  close(output[0]);
+  unlink((std::string(directory) + "/a.sock").c_str());
+  unlink((std::string(directory) + "/b.sock").c_str());
+  rmdir(directory);
+
+  CHECK(!report.empty());
+  // Both fixture hosts with the totals from their /proc/stat
+  CHECK(Line(report, "Total Processes").find("805") != std::string::npos);
+  CHECK(Line(report, "node-a  ").find("403") != std::string::npos);
+  CHECK(Line(report, "node-b  ").find("402") != std::string::npos);
+  // The fleet top 3 merges both nodes ordered by CPU
+  const std::size_t beta = report.find("beta-worker");
+  const std::size_t alpha = report.find("alpha-server");
+  CHECK(beta != std::string::npos && alpha != std::string::npos);
+  CHECK(beta < alpha);
+  CHECK(Line(report, "beta-worker").rfind("node-b", 0) == 0);
+  CHECK(Line(report, "alpha-server").rfind("node-a", 0) == 0);
+  CHECK(report.find("alpha-cron") == std::string::npos);
+  return 0;
+}
@@ -0,0 +1,150 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "check.h"
+#include "keyed_fields.h"
+
+namespace {
+struct Record {
+  long first{-1};
+  long target{-1};
+  long after{-1};
+  long last{-1};
+};
+
+constexpr KeyedFields::Field<Record> kRecord[] = {{"First", &Record::first},
+                                                  {"Target", &Record::target},
+                                                  {"After", &Record::after},
+                                                  {"Last", &Record::last}};
+
+constexpr KeyedFields::Field<Record> kTarget[] = {{"Target", &Record::target}};
+
+struct Release {
+  std::string name;
+  std::string version;
+};
+
+constexpr KeyedFields::Field<Release, std::string> kRelease[] = {
+    {"NAME", &Release::name}, {"VERSION", &Release::version}};
+
+// Padding lines up to offset bytes, so the next line starts there
+std::string Padding(std::size_t offset) {
+  std::string text;
+  while (text.size() + 100 <= offset) {
+    text += "Pad: " + std::string(94, 'x') + '\n';
+  }
+  text += "Pad:" + std::string(offset - text.size() - 5, ' ') + '\n';
+  return text;
+}
+
+void Write(const std::string& path, const std::string& text) {
+  std::ofstream(path) << text;
+}
+}  // namespace
+
+int main() {
+  char directory[] = "/tmp/keyed_fields_test.XXXXXX";
+  CHECK(mkdtemp(directory) != nullptr);
+  const std::string path = std::string(directory) + "/fields";
+
+  // A line straddling the 4096 byte buffer is joined, not split
+  std::string text = "First: 1\n" + Padding(4090 - 9) + "Target: 123456\n";
+  CHECK(text.find("Target") == 4090);
+  Write(path, text + "Last: 4\n");
+  Record record;
+  uint64_t found = KeyedFields::Scan(path, ':', kRecord, record);
+  CHECK(record.first == 1);
+  CHECK(record.target == 123456);
+  CHECK(record.last == 4);
+  // A missing key leaves its bit clear and its member untouched
+  CHECK(found == 0b1011);
+  CHECK(record.after == -1);
+
+  // Scanning stops once every key was found, later duplicates are not read
+  Write(path, "Target: 5\nTarget: 6\n");
+  record = Record();
+  CHECK(KeyedFields::Scan(path, ':', kTarget, record) == 1);
+  CHECK(record.target == 5);
+
+  // Lines longer than the buffer are skipped whole, the next line is read
+  Write(path, "First: 1\nAfter: " + std::string(5000, '9') + "\nTarget: 2\n" +
+                  "Last: " + std::string(9000, '8') + "\nAfter: 3\n");
+  record = Record();
+  found = KeyedFields::Scan(path, ':', kRecord, record);
+  CHECK(found == 0b0111);
+  CHECK(record.first == 1);
+  CHECK(record.target == 2);
+  CHECK(record.after == 3);
+  CHECK(record.last == -1);
+
+  // The last line needs no newline
+  Write(path, "First: 1\nLast: 4");
+  record = Record();
+  CHECK(KeyedFields::Scan(path, ':', kRecord, record) == 0b1001);
+  CHECK(record.last == 4);
+
+  // LineReader hands out every line in order, empty ones included
+  Write(path, Padding(4093) + "abcdef\n\nend");
+  {
+    KeyedFields::LineReader reader(path);
+    CHECK(reader.IsOpen());
+    std::vector<std::string> lines;
+    std::string_view line;
+    while (reader.Next(line)) lines.emplace_back(line);
+    CHECK(lines.size() == 44);
+    CHECK(lines[40] == "Pad:" + std::string(88, ' '));
+    CHECK(lines[41] == "abcdef");
+    CHECK(lines[42].empty());
+    CHECK(lines[43] == "end");
+  }
+
+  // String schemas with '=' trim blanks and quotes
+  Write(path, "NAME=\"Ubuntu\"\nID=ubuntu\nVERSION=\"20.04 LTS\"\n");
+  Release release;
+  CHECK(KeyedFields::Scan(path, '=', kRelease, release) == 0b11);
+  CHECK(release.name == "Ubuntu");
+  CHECK(release.version == "20.04 LTS");
+
+  // Text already in memory parses the same way
+  record = Record();
+  CHECK(KeyedFields::Parse("First:\t7\nLast:  -2 kB\n", ':', kRecord,
+                           record) == 0b1001);
+  CHECK(record.first == 7);
+  CHECK(record.last == -2);
+
+  // A missing file finds nothing
+  unlink(path.c_str());
+  record = Record();
+  CHECK(KeyedFields::Scan(path, ':', kRecord, record) == 0);
+  CHECK(!KeyedFields::LineReader(path).IsOpen());
+
+  rmdir(directory);
+  return 0;
+}
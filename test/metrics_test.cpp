@@ -0,0 +1,151 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "check.h"
+#include "metrics_server.h"
+#include "network.h"
+#include "snapshot.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// Any free loopback port will do
+std::string Serve(std::unique_ptr<MetricsServer>& server) {
+  for (int port = 20000 + getpid() % 20000; port < 65536; ++port) {
+    const std::string endpoint = "127.0.0.1:" + std::to_string(port);
+    try {
+      server = std::make_unique<MetricsServer>(endpoint);
+      return endpoint;
+    } catch (const std::system_error&) {
+    }
+  }
+  CHECK(!"no free port");
+  return "";
+}
+
+// Sends the request and polls the server until it closes the connection
+std::string Scrape(MetricsServer& server, const std::string& endpoint,
+                   const std::string& request) {
+  const int fd = Network::Connect(endpoint);
+  CHECK(fd >= 0);
+  const Clock::time_point deadline = Clock::now() + std::chrono::seconds(5);
+  std::size_t sent{0};
+  std::string response;
+  while (1) {
+    CHECK(Clock::now() < deadline);
+    server.Poll();
+    if (sent < request.size()) {
+      const ssize_t written = send(fd, request.data() + sent,
+                                   request.size() - sent, MSG_NOSIGNAL);
+      CHECK(written >= 0 || errno == EAGAIN || errno == EWOULDBLOCK);
+      if (written > 0) sent += written;
+      continue;
+    }
+    char buffer[4096];
+    const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+    if (received == 0) break;
+    if (received < 0) {
+      CHECK(errno == EAGAIN || errno == EWOULDBLOCK);
+      usleep(1000);
+      continue;
+    }
+    response.append(buffer, received);
+  }
+  close(fd);
+  return response;
+}
+
+std::string Body(const std::string& response) {
+  const std::size_t head = response.find("\r\n\r\n");
+  CHECK(head != std::string::npos);
+  return response.substr(head + 4);
+}
+
+void Metrics(MetricsServer& server, const std::string& endpoint) {
+  const std::string response =
+      Scrape(server, endpoint, "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n");
+  CHECK(response.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+  CHECK(response.find("application/openmetrics-text") != std::string::npos);
+  const std::string body = Body(response);
+  CHECK(body.rfind("# TYPE monitor info\n", 0) == 0);
+  CHECK(body.size() >= 6 && body.compare(body.size() - 6, 6, "# EOF\n") == 0);
+  CHECK(body.find("monitor_forks_total 123\n") != std::string::npos);
+  CHECK(body.find("monitor_process_cpu_utilization_ratio{pid=\"100\","
+                  "user=\"root\",command=\"/usr/bin/alpha server\"} 0.75\n") !=
+        std::string::npos);
+}
+
+void NotFound(MetricsServer& server, const std::string& endpoint) {
+  const std::string response =
+      Scrape(server, endpoint, "GET /other HTTP/1.1\r\n\r\n");
+  CHECK(response.rfind("HTTP/1.1 404 Not Found\r\n", 0) == 0);
+  CHECK(Body(response) == "metrics are served at /metrics\n");
+}
+
+// A client that never sends a request is disconnected after a few seconds
+void Idle(MetricsServer& server, const std::string& endpoint) {
+  const int fd = Network::Connect(endpoint);
+  CHECK(fd >= 0);
+  const Clock::time_point start = Clock::now();
+  while (1) {
+    CHECK(Clock::now() - start < std::chrono::seconds(15));
+    server.Poll();
+    char byte;
+    const ssize_t received = recv(fd, &byte, 1, 0);
+    if (received == 0) break;
+    CHECK(received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+    usleep(10000);
+  }
+  CHECK(Clock::now() - start >= std::chrono::seconds(1));
+  close(fd);
+}
+}  // namespace
+
+int main() {
+  std::unique_ptr<MetricsServer> server;
+  const std::string endpoint = Serve(server);
+  Snapshot snapshot;
+  snapshot.host = "node-a";
+  snapshot.os = "Fixture Linux";
+  snapshot.kernel = "6.1.0-fixture";
+  snapshot.total_processes = 123;
+  // cmdline separates arguments with NUL bytes
+  const std::string_view command("/usr/bin/alpha\0server", 21);
+  snapshot.processes.push_back({100, 0.75f, 512, 900,
+                                snapshot.strings.Copy("root"),
+                                snapshot.strings.Copy(command)});
+  server->Update(snapshot);
+  Metrics(*server, endpoint);
+  NotFound(*server, endpoint);
+  Idle(*server, endpoint);
+  return 0;
+}
@@ -0,0 +1,110 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "check.h"
+#include "linux_parser.h"
+#include "network_traffic.h"
+
+namespace {
+const char kHeader[] =
+    "Inter-|   Receive                                                |  "
+    "Transmit\n"
+    " face |bytes    packets errs drop fifo frame compressed multicast|bytes"
+    "    packets errs drop fifo colls carrier compressed\n";
+
+std::string Device(const char* name, long bytes) {
+  return std::string("  ") + name + ": " + std::to_string(bytes) +
+         " 10 0 0 0 0 0 0 " + std::to_string(bytes) + " 10 0 0 0 0 0 0\n";
+}
+
+void WriteDevices(const std::string& root, const std::string& devices) {
+  std::ofstream(root + "net/dev") << kHeader << devices;
+}
+
+bool Named(const NetworkTraffic::Interface& interface, const char* name) {
+  return std::strcmp(interface.name, name) == 0;
+}
+}  // namespace
+
+// Interfaces keep their id while they exist, and the slot of one that
+// vanished is reused by the next new interface instead of growing the array
+int main() {
+  char directory[] = "/tmp/network_traffic_test.XXXXXX";
+  CHECK(mkdtemp(directory) != nullptr);
+  const std::string root = std::string(directory) + "/";
+  CHECK(mkdir((root + "net").c_str(), 0755) == 0);
+  LinuxParser::SetProcDirectory(root);
+
+  WriteDevices(root, Device("lo", 100) + Device("eth0", 200) +
+                         Device("veth1", 300));
+  NetworkTraffic network;
+  network.Update();
+  const auto& interfaces = network.Interfaces();
+  CHECK(interfaces.size() == 3);
+  CHECK(Named(interfaces[0], "lo"));
+  CHECK(Named(interfaces[1], "eth0"));
+  CHECK(Named(interfaces[2], "veth1"));
+
+  // veth1 goes away: its slot is freed, the others keep their ids
+  WriteDevices(root, Device("lo", 100) + Device("eth0", 200));
+  network.Update();
+  CHECK(interfaces.size() == 3);
+  CHECK(Named(interfaces[0], "lo"));
+  CHECK(Named(interfaces[1], "eth0"));
+  CHECK(!interfaces[2].present);
+
+  // A new interface takes the freed slot with fresh counters
+  WriteDevices(root, Device("veth2", 50) + Device("lo", 100) +
+                         Device("eth0", 200));
+  network.Update();
+  CHECK(interfaces.size() == 3);
+  CHECK(Named(interfaces[0], "lo"));
+  CHECK(Named(interfaces[1], "eth0"));
+  CHECK(Named(interfaces[2], "veth2"));
+  CHECK(interfaces[2].present);
+  CHECK(interfaces[2].rx_bytes == 50);
+  CHECK(interfaces[2].rx_bytes_rate == 0);
+
+  // Churn of short lived interfaces does not grow the array
+  for (int i = 0; i < 100; ++i) {
+    const std::string name = "veth" + std::to_string(i + 3);
+    WriteDevices(root, Device("lo", 100) + Device("eth0", 200) +
+                           Device(name.c_str(), 10));
+    network.Update();
+  }
+  CHECK(interfaces.size() <= 4);
+  CHECK(Named(interfaces[0], "lo"));
+  CHECK(Named(interfaces[1], "eth0"));
+
+  unlink((root + "net/dev").c_str());
+  rmdir((root + "net").c_str());
+  rmdir(directory);
+  return 0;
+}
@@ -0,0 +1,74 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "check.h"
+#include "linux_parser.h"
+#include "numa.h"
+
+namespace {
+// cpu0 stays idle; cpu1 is busy and only listed while online
+void WriteStat(const std::string& root, long idle, long busy, bool online) {
+  std::ofstream stat(root + "stat");
+  stat << "cpu  " << busy << " 0 0 " << 2 * idle << " 0 0 0 0 0 0\n"
+       << "cpu0 0 0 0 " << idle << " 0 0 0 0 0 0\n";
+  if (online) stat << "cpu1 " << busy << " 0 0 " << idle << " 0 0 0 0 0 0\n";
+  stat << "intr 0\n";
+}
+}  // namespace
+
+// A CPU that goes offline must not keep a stale sample that is later
+// compared against one several intervals apart
+int main() {
+  char directory[] = "/tmp/numa_test.XXXXXX";
+  CHECK(mkdtemp(directory) != nullptr);
+  const std::string root = std::string(directory) + "/";
+  LinuxParser::SetProcDirectory(root);
+
+  NumaTopology numa;
+  const int node = numa.NodeOf(1);
+  WriteStat(root, 100, 100, true);
+  numa.Update();
+  WriteStat(root, 200, 100, false);
+  numa.Update();
+  CHECK(numa.Utilization(node) == 0);
+  WriteStat(root, 300, 100, false);
+  numa.Update();
+  CHECK(numa.Utilization(node) == 0);
+  // Back online after two intervals of work: no interval covers it
+  WriteStat(root, 400, 10000, true);
+  numa.Update();
+  CHECK(numa.Utilization(node) == 0);
+  // The next interval measures it again
+  WriteStat(root, 500, 10100, true);
+  numa.Update();
+  CHECK(numa.Utilization(node) > 0);
+
+  unlink((root + "stat").c_str());
+  rmdir(directory);
+  return 0;
+}
@@ -0,0 +1,97 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "linux_parser.h"
+#include "pid_set.h"
+
+// usage: pid_set_benchmark [DIRECTORIES]
+// Times PidSet::Scan() over a fixture proc root holding DIRECTORIES
+// numeric directories, 100000 by default, next to a few non-PID entries.
+// Not run by ctest; the cost is dominated by getdents64 in the kernel and
+// depends on the filesystem the fixture lives on.
+int main(int argc, char* argv[]) {
+  const int directories = argc > 1 ? std::atoi(argv[1]) : 100000;
+  CHECK(directories > 0);
+  const char* temporary = std::getenv("TMPDIR");
+  std::string root = std::string(temporary != nullptr ? temporary : "/tmp") +
+                     "/pid_set_benchmark.XXXXXX";
+  CHECK(mkdtemp(root.data()) != nullptr);
+  root += '/';
+  for (int pid = 1; pid <= directories; ++pid) {
+    CHECK(mkdir((root + std::to_string(pid)).c_str(), 0755) == 0);
+  }
+  for (const char* name : {"self", "sys", "1x"}) {
+    CHECK(mkdir((root + name).c_str(), 0755) == 0);
+  }
+  LinuxParser::SetProcDirectory(root);
+
+  PidSet pids;
+  pids.Scan();
+  CHECK(pids.Pids().size() == static_cast<std::size_t>(directories));
+  const int runs{20};
+  std::vector<double> milliseconds;
+  rusage before{};
+  getrusage(RUSAGE_SELF, &before);
+  for (int run = 0; run < runs; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    pids.Scan();
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    milliseconds.push_back(elapsed.count());
+  }
+  rusage after{};
+  getrusage(RUSAGE_SELF, &after);
+  // CPU time split between the kernel's getdents64 and the parsing
+  auto seconds = [](const timeval& time) {
+    return time.tv_sec + time.tv_usec / 1e6;
+  };
+  const double system = seconds(after.ru_stime) - seconds(before.ru_stime);
+  const double user = seconds(after.ru_utime) - seconds(before.ru_utime);
+  std::sort(milliseconds.begin(), milliseconds.end());
+  std::printf("PidSet::Scan() over %d directories: median %.3f ms, "
+              "min %.3f ms, max %.3f ms, %.0f%% of the CPU time in the "
+              "kernel\n",
+              directories, milliseconds[runs / 2], milliseconds.front(),
+              milliseconds.back(),
+              system + user > 0 ? 100 * system / (system + user) : 0.0);
+
+  for (int pid = 1; pid <= directories; ++pid) {
+    rmdir((root + std::to_string(pid)).c_str());
+  }
+  for (const char* name : {"self", "sys", "1x"}) {
+    rmdir((root + name).c_str());
+  }
+  rmdir(root.c_str());
+  return 0;
+}
@@ -0,0 +1,106 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "check.h"
+#include "fd_scanner.h"
+#include "linux_parser.h"
+#include "proc_reader.h"
+#include "process.h"
+
+namespace {
+const char kStatm[] = "25600 2000 500 10 0 1000 0\n";
+const char kIo[] = "read_bytes: 4096\nwrite_bytes: 0\n";
+const char kStatus[] = "Uid:\t1000\t1000\t1000\t1000\n";
+
+std::string Stat(const char* comm, long start_time, long utime = 3000) {
+  return "100 (" + std::string(comm) +
+         ") S 1 100 100 0 -1 4194304 500 0 2 0 " + std::to_string(utime) +
+         " 1000 0 0 20 0 1 0 " + std::to_string(start_time) +
+         " 104857600 2000\n";
+}
+
+void WriteCmdline(const std::string& root, const char* command) {
+  std::ofstream(root + "100/cmdline") << command;
+}
+}  // namespace
+
+// A PID is only carried over while it names the same process: a new start
+// time means the PID was reused, a new comm means the process called exec
+int main() {
+  char directory[] = "/tmp/process_test.XXXXXX";
+  CHECK(mkdtemp(directory) != nullptr);
+  const std::string root = std::string(directory) + "/";
+  CHECK(mkdir((root + "100").c_str(), 0755) == 0);
+  LinuxParser::SetProcDirectory(root);
+
+  std::string stat = Stat("shell", 5000);
+  Process process(100, {stat, kStatm, kIo, kStatus}, 1000);
+  WriteCmdline(root, "/bin/sh");
+  CHECK(process.Command() == "/bin/sh");
+
+  // Same process, same command line
+  WriteCmdline(root, "/bin/sh -c true");
+  CHECK(process.Update({stat, kStatm, kIo, kStatus}, 1000, 1));
+  CHECK(process.Command() == "/bin/sh");
+
+  // exec() replaces the comm and the command line
+  stat = Stat("server", 5000);
+  WriteCmdline(root, "/usr/bin/server --port 80");
+  CHECK(process.Update({stat, kStatm, kIo, kStatus}, 1000, 1));
+  CHECK(process.Name() == "server");
+  CHECK(process.Command() == "/usr/bin/server --port 80");
+
+  // The PID now belongs to a process started later
+  const std::string reused = Stat("other", 9000);
+  CHECK(!process.Update({reused, kStatm, kIo, kStatus}, 1000, 1));
+  CHECK(process.Name() == "server");
+
+  // A denied descriptor listing is not retried while the process is idle
+  FdScanner scanner;
+  const long later = 1L << 62;
+  CHECK(process.CountFds(scanner, later));
+  CHECK(process.Fds().total == -1);
+  CHECK(mkdir((root + "100/fd").c_str(), 0755) == 0);
+  CHECK(symlink("pipe:[7]", (root + "100/fd/0").c_str()) == 0);
+  CHECK(!process.CountFds(scanner, later));
+  CHECK(process.Fds().total == -1);
+  // Once it ran it is listed again
+  stat = Stat("server", 5000, 3001);
+  CHECK(process.Update({stat, kStatm, kIo, kStatus}, 1000, 1));
+  CHECK(process.CountFds(scanner, later));
+  CHECK(process.Fds().total == 1);
+  CHECK(process.Fds().pipes == 1);
+
+  unlink((root + "100/fd/0").c_str());
+  rmdir((root + "100/fd").c_str());
+  unlink((root + "100/cmdline").c_str());
+  rmdir((root + "100").c_str());
+  rmdir(directory);
+  return 0;
+}
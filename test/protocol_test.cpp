@@ -0,0 +1,140 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <stdexcept>
+#include <string>
+
+#include "check.h"
+#include "protocol.h"
+#include "snapshot.h"
+
+namespace {
+void FillSnapshot(Snapshot& snapshot) {
+  snapshot.host = "node-a";
+  snapshot.os = "Fixture Linux";
+  snapshot.kernel = "6.1.0-fixture";
+  snapshot.cpu = 0.25f;
+  snapshot.memory = 0.5f;
+  snapshot.total_processes = 123;
+  snapshot.running_processes = 4;
+  snapshot.uptime = 1000;
+  snapshot.strings.Reset();
+  snapshot.processes.resize(2);
+  snapshot.processes[0] = {100, 0.75f, 512, 900,
+                           snapshot.strings.Copy("root"),
+                           snapshot.strings.Copy("/usr/bin/alpha-server")};
+  snapshot.processes[1] = {-1, 0.0f, 1L << 40, 0, snapshot.strings.Copy(""),
+                           snapshot.strings.Copy("")};
+}
+
+void RoundTrip() {
+  Snapshot sent;
+  FillSnapshot(sent);
+  std::string frame;
+  Protocol::Encode(sent, frame);
+  CHECK(Protocol::FrameSize(frame.data(), frame.size()) == frame.size());
+
+  Snapshot received;
+  CHECK(Protocol::Decode(frame.data(), frame.size(), received) ==
+        frame.size());
+  CHECK(received.host == sent.host);
+  CHECK(received.os == sent.os);
+  CHECK(received.kernel == sent.kernel);
+  CHECK(received.cpu == sent.cpu);
+  CHECK(received.memory == sent.memory);
+  CHECK(received.total_processes == sent.total_processes);
+  CHECK(received.running_processes == sent.running_processes);
+  CHECK(received.uptime == sent.uptime);
+  CHECK(received.processes.size() == sent.processes.size());
+  for (std::size_t i = 0; i < sent.processes.size(); ++i) {
+    CHECK(received.processes[i].pid == sent.processes[i].pid);
+    CHECK(received.processes[i].cpu == sent.processes[i].cpu);
+    CHECK(received.processes[i].ram == sent.processes[i].ram);
+    CHECK(received.processes[i].uptime == sent.processes[i].uptime);
+    CHECK(received.processes[i].user == sent.processes[i].user);
+    CHECK(received.processes[i].command == sent.processes[i].command);
+  }
+}
+
+// Partial frames are not consumed, whatever the split point
+void PartialFrames() {
+  Snapshot sent;
+  FillSnapshot(sent);
+  std::string frame;
+  Protocol::Encode(sent, frame);
+  Snapshot received;
+  for (std::size_t size = 0; size < frame.size(); ++size) {
+    CHECK(Protocol::Decode(frame.data(), size, received) == 0);
+  }
+  CHECK(Protocol::FrameSize(frame.data(), Protocol::kHeaderSize - 1) == 0);
+  CHECK(Protocol::FrameSize(frame.data(), Protocol::kHeaderSize) ==
+        frame.size());
+}
+
+void MalformedFrames() {
+  Snapshot sent;
+  FillSnapshot(sent);
+  std::string frame;
+  Protocol::Encode(sent, frame);
+  Snapshot received;
+
+  std::string bad_magic = frame;
+  bad_magic[0] = 'X';
+  bool thrown{false};
+  try {
+    Protocol::Decode(bad_magic.data(), bad_magic.size(), received);
+  } catch (std::runtime_error& e) {
+    thrown = true;
+  }
+  CHECK(thrown);
+
+  std::string oversized = frame;
+  oversized[11] = 0x7f;
+  thrown = false;
+  try {
+    Protocol::FrameSize(oversized.data(), oversized.size());
+  } catch (std::runtime_error& e) {
+    thrown = true;
+  }
+  CHECK(thrown);
+
+  // A payload shorter than its process count claims
+  std::string truncated = frame;
+  truncated[8] = 40;
+  truncated[9] = 0;
+  thrown = false;
+  try {
+    Protocol::Decode(truncated.data(), truncated.size(), received);
+  } catch (std::runtime_error& e) {
+    thrown = true;
+  }
+  CHECK(thrown);
+}
+}  // namespace
+
+int main() {
+  RoundTrip();
+  PartialFrames();
+  MalformedFrames();
+  return 0;
+}
@@ -0,0 +1,67 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <unistd.h>
+
+#include <chrono>
+
+#include "check.h"
+#include "scheduler.h"
+
+namespace {
+// Burns CPU time so a collection is over any budget
+void Spin(std::chrono::milliseconds duration) {
+  const auto end = std::chrono::steady_clock::now() + duration;
+  volatile unsigned long sink{0};
+  while (std::chrono::steady_clock::now() < end) sink = sink + 1;
+}
+}  // namespace
+
+// Early wakeups must not count as cheap collections: a burst of them
+// would otherwise undo the back-off while collecting is expensive
+int main() {
+  int wake[2];
+  CHECK(pipe(wake) == 0);
+  Scheduler scheduler(std::chrono::milliseconds(10), 0.05);
+  scheduler.WakeOn(wake[0]);
+  while (scheduler.Backoff() < 4) {
+    const unsigned due = scheduler.Wait();
+    scheduler.BeginCollection();
+    if (due != 0) Spin(std::chrono::milliseconds(8));
+    scheduler.EndCollection();
+  }
+  const int backoff = scheduler.Backoff();
+
+  char byte{0};
+  CHECK(write(wake[1], &byte, 1) == 1);
+  int wakeups{0};
+  while (wakeups < 100) {
+    const unsigned due = scheduler.Wait();
+    scheduler.BeginCollection();
+    scheduler.EndCollection();
+    if (due == 0) ++wakeups;
+  }
+  CHECK(scheduler.Backoff() >= backoff);
+  close(wake[0]);
+  close(wake[1]);
+  return 0;
+}
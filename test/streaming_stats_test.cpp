@@ -0,0 +1,104 @@
+// MIT License
+//
+// Copyright (c) 2021 Xi Chen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cmath>
+#include <random>
+
+#include "check.h"
+#include "streaming_stats.h"
+
+namespace {
+bool Near(double value, double expected, double tolerance) {
+  return std::fabs(value - expected) <= tolerance;
+}
+
+// Until five samples arrived the quantile is read from the sorted samples
+void ExactQuantile() {
+  StreamingStats stats(0.5, 60);
+  CHECK(stats.Quantile() == 0);
+  stats.Add(3, 1);
+  stats.Add(1, 1);
+  stats.Add(2, 1);
+  CHECK(stats.Count() == 3);
+  CHECK(stats.Quantile() == 2);
+}
+
+// The P-square estimate against the known quantiles of a uniform and a
+// normal distribution
+void EstimatedQuantile() {
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  std::normal_distribution<double> normal(0, 1);
+  StreamingStats median(0.5, 60);
+  StreamingStats p99(0.99, 60);
+  StreamingStats p90(0.9, 60);
+  for (int i = 0; i < 100000; ++i) {
+    const double value = uniform(generator);
+    median.Add(value, 1);
+    p99.Add(value, 1);
+    p90.Add(normal(generator), 1);
+  }
+  CHECK(median.Count() == 100000);
+  CHECK(Near(median.Quantile(), 0.5, 0.02));
+  CHECK(Near(p99.Quantile(), 0.99, 0.01));
+  CHECK(Near(p90.Quantile(), 1.2816, 0.05));
+}
+
+// A sample covering one time constant moves the mean by 1 - 1/e of the
+// difference
+void WeightedMean() {
+  StreamingStats stats(0.5, 10);
+  stats.Add(0, 1);
+  CHECK(stats.Mean() == 0);
+  CHECK(stats.Variance() == 0);
+  stats.Add(10, 10);
+  const double alpha = 1 - std::exp(-1.0);
+  CHECK(Near(stats.Mean(), 10 * alpha, 1e-9));
+  CHECK(Near(stats.Variance(), (1 - alpha) * alpha * 100, 1e-9));
+  CHECK(Near(stats.Seconds(), 11, 1e-9));
+
+  // A constant series has its value as mean and no variance
+  StreamingStats constant(0.5, 10);
+  for (int i = 0; i < 100; ++i) constant.Add(7, 1);
+  CHECK(Near(constant.Mean(), 7, 1e-9));
+  CHECK(Near(constant.StdDev(), 0, 1e-9));
+}
+
+// With a window far longer than the samples, mean and variance approach
+// those of the distribution, 1/2 and 1/12 for uniform samples
+void WeightedVariance() {
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  StreamingStats stats(0.5, 20000);
+  for (int i = 0; i < 200000; ++i) stats.Add(uniform(generator), 1);
+  CHECK(Near(stats.Mean(), 0.5, 0.02));
+  CHECK(Near(stats.Variance(), 1.0 / 12, 0.005));
+}
+}  // namespace
+
+int main() {
+  ExactQuantile();
+  EstimatedQuantile();
+  WeightedMean();
+  WeightedVariance();
+  return 0;
+}